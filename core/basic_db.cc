@@ -91,6 +91,24 @@ DB::Status BasicDB::Delete(const std::string &table, const std::string &key) {
 
 DB::Status BasicDB::ReadIdx(const uint64_t idx, std::string &data) { return Status(); }
 
+DB::Status BasicDB::BeginTransaction() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  *out_ << "BEGIN" << std::endl;
+  return kOK;
+}
+
+DB::Status BasicDB::CommitTransaction() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  *out_ << "COMMIT" << std::endl;
+  return kOK;
+}
+
+DB::Status BasicDB::AbortTransaction() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  *out_ << "ABORT" << std::endl;
+  return kOK;
+}
+
 DB *NewBasicDB() {
   return new BasicDB;
 }
@@ -38,6 +38,12 @@ class BasicDB : public DB {
 
   Status ReadIdx(const uint64_t idx, std::string &data);
 
+  Status BeginTransaction();
+
+  Status CommitTransaction();
+
+  Status AbortTransaction();
+
  private:
   static std::mutex mutex_;
 
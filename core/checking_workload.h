@@ -15,6 +15,12 @@ public:
     void Init(const utils::Properties &p) override;
     bool DoInsert(DB &db, ThreadState *state) override;
     bool DoTransaction(DB &db, ThreadState *state) override;
+    void DoInsertAsync(DB &db, ThreadState *state, DoneCallback done) override {
+      done(DoInsert(db, state));
+    }
+    void DoTransactionAsync(DB &db, ThreadState *state, DoneCallback done) override {
+      done(DoTransaction(db, state));
+    }
 
 protected:
     int stop_at_;
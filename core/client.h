@@ -9,8 +9,10 @@
 #ifndef YCSB_C_CLIENT_H_
 #define YCSB_C_CLIENT_H_
 
+#include <deque>
 #include <iostream>
 #include <string>
+#include <vector>
 
 #include "db.h"
 #include "core_workload.h"
@@ -28,7 +30,21 @@ inline int ClientThread(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const utils::Pro
       db->Init();
     }
 
-    ThreadState *thread_state = wl->InitThread(p, thread_id, thread_count, num_ops);
+    // operations kept in flight through the DB's async interface, 1 runs the plain synchronous loop
+    const int queue_depth = std::stoi(p.GetProperty("async.queuedepth", "1"));
+    // closed-loop virtual clients multiplexed on this thread, each with its own ThreadState
+    const int virtual_clients = std::stoi(p.GetProperty("virtualclients", "1"));
+
+    std::vector<ThreadState *> thread_states;
+    if (virtual_clients <= 1) {
+      thread_states.push_back(wl->InitThread(p, thread_id, thread_count, num_ops));
+    } else {
+      for (int v = 0; v < virtual_clients; ++v) {
+        int client_ops = num_ops / virtual_clients + (v < num_ops % virtual_clients);
+        thread_states.push_back(wl->InitThread(p, thread_id * virtual_clients + v,
+                                               thread_count * virtual_clients, client_ops));
+      }
+    }
     init_latch->CountDown();
 
     bool count_on = (sec_skip == 0);
@@ -36,7 +52,7 @@ inline int ClientThread(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const utils::Pro
     int skipped_ok = 0;
 
     int oks = 0;
-    for (int i = 0; i < num_ops; ++i) {
+    auto before_op = [&]() {
       if (!count_on) {
         auto elapse = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now() - start).count();
         count_on = (elapse > sec_skip);
@@ -45,14 +61,85 @@ inline int ClientThread(ycsbc::DB *db, ycsbc::CoreWorkload *wl, const utils::Pro
       if (rlim) {
         rlim->Consume(1);
       }
-      if (is_loading) {
-        oks += wl->DoInsert(*db, thread_state);
-      } else {
-        oks += wl->DoTransaction(*db, thread_state);
+    };
+
+    if (virtual_clients > 1) {
+      // Each virtual client has at most one op outstanding and is resumed from
+      // the ready queue once it completes, never from inside the callback, so
+      // inline-completing bindings do not recurse.
+      struct VirtualClient {
+        ThreadState *state;
+        int remaining;
+      };
+      std::vector<VirtualClient> clients;
+      std::deque<VirtualClient *> ready;
+      for (int v = 0; v < virtual_clients; ++v) {
+        clients.push_back({thread_states[v], num_ops / virtual_clients + (v < num_ops % virtual_clients)});
+      }
+      for (VirtualClient &vc : clients) {
+        ready.push_back(&vc);
+      }
+      int live = virtual_clients;
+      while (live > 0) {
+        while (!ready.empty()) {
+          VirtualClient *vc = ready.front();
+          ready.pop_front();
+          if (vc->remaining == 0) {
+            live--;
+            continue;
+          }
+          vc->remaining--;
+          before_op();
+          auto done = [&ready, &oks, vc](bool ok) {
+            oks += ok;
+            ready.push_back(vc);
+          };
+          if (is_loading) {
+            wl->DoInsertAsync(*db, vc->state, done);
+          } else {
+            wl->DoTransactionAsync(*db, vc->state, done);
+          }
+        }
+        if (live > 0) {
+          db->Poll();
+        }
+      }
+    } else if (queue_depth > 1) {
+      int in_flight = 0;
+      auto done = [&in_flight, &oks](bool ok) {
+        in_flight--;
+        oks += ok;
+      };
+      int i = 0;
+      while (i < num_ops || in_flight > 0) {
+        while (i < num_ops && in_flight < queue_depth) {
+          before_op();
+          in_flight++;
+          i++;
+          if (is_loading) {
+            wl->DoInsertAsync(*db, thread_states[0], done);
+          } else {
+            wl->DoTransactionAsync(*db, thread_states[0], done);
+          }
+        }
+        if (in_flight > 0) {
+          db->Poll();
+        }
+      }
+    } else {
+      for (int i = 0; i < num_ops; ++i) {
+        before_op();
+        if (is_loading) {
+          oks += wl->DoInsert(*db, thread_states[0]);
+        } else {
+          oks += wl->DoTransaction(*db, thread_states[0]);
+        }
       }
     }
 
-    delete thread_state;
+    for (ThreadState *state : thread_states) {
+      delete state;
+    }
 
     if (cleanup_db) {
       db->Cleanup();
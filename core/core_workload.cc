@@ -33,13 +33,16 @@ const char *ycsbc::kOperationString[ycsbc::MAXOPTYPE] = {
   "READMODIFYWRITE",
   "DELETE",
   "RDIDX",
+  "COMMIT",
+  "ABORT",
   "INSERT-FAILED",
   "READ-FAILED",
   "UPDATE-FAILED",
   "SCAN-FAILED",
   "READMODIFYWRITE-FAILED",
   "DELETE-FAILED",
-  "RDIDX-FAILED"
+  "RDIDX-FAILED",
+  "COMMIT-FAILED"
 };
 
 const string CoreWorkload::TABLENAME_PROPERTY = "table";
@@ -135,17 +138,17 @@ void CoreWorkload::Init(const utils::Properties &p) {
   double rdidx_proportion = std::stod(p.GetProperty(RDIDX_PROPORTION_PROPERTY,
                                                     RDIDX_PROPORTION_DEFAULT));
 
-  record_count_ = std::stoi(p.GetProperty(RECORD_COUNT_PROPERTY));
+  record_count_ = std::stoull(p.GetProperty(RECORD_COUNT_PROPERTY));
   std::string request_dist = p.GetProperty(REQUEST_DISTRIBUTION_PROPERTY,
                                            REQUEST_DISTRIBUTION_DEFAULT);
   int min_scan_len = std::stoi(p.GetProperty(MIN_SCAN_LENGTH_PROPERTY, MIN_SCAN_LENGTH_DEFAULT));
   int max_scan_len = std::stoi(p.GetProperty(MAX_SCAN_LENGTH_PROPERTY, MAX_SCAN_LENGTH_DEFAULT));
   std::string scan_len_dist = p.GetProperty(SCAN_LENGTH_DISTRIBUTION_PROPERTY,
                                             SCAN_LENGTH_DISTRIBUTION_DEFAULT);
-  int insert_start = std::stoi(p.GetProperty(INSERT_START_PROPERTY, INSERT_START_DEFAULT));
+  uint64_t insert_start = std::stoull(p.GetProperty(INSERT_START_PROPERTY, INSERT_START_DEFAULT));
 
-  uint64_t min_read_idx = std::stoi(p.GetProperty(MIN_READ_IDX_PROPERTY, MIN_READ_IDX_DEFAULT));
-  uint64_t max_read_idx = std::stoi(p.GetProperty(MAX_READ_IDX_PROPERTY, MAX_READ_IDX_DEFAULT));
+  uint64_t min_read_idx = std::stoull(p.GetProperty(MIN_READ_IDX_PROPERTY, MIN_READ_IDX_DEFAULT));
+  uint64_t max_read_idx = std::stoull(p.GetProperty(MAX_READ_IDX_PROPERTY, MAX_READ_IDX_DEFAULT));
 
   zero_padding_ = std::stoi(p.GetProperty(ZERO_PADDING_PROPERTY, ZERO_PADDING_DEFAULT));
 
@@ -192,8 +195,8 @@ void CoreWorkload::Init(const utils::Properties &p) {
     // that is larger than what exists at the beginning of the test.
     // If the generator picks a key that is not inserted yet, we just ignore it
     // and pick another key.
-    int op_count = std::stoi(p.GetProperty(OPERATION_COUNT_PROPERTY));
-    int new_keys = (int)(op_count * insert_proportion * 2); // a fudge factor
+    uint64_t op_count = std::stoull(p.GetProperty(OPERATION_COUNT_PROPERTY));
+    uint64_t new_keys = (uint64_t)(op_count * insert_proportion * 2); // a fudge factor
     if (p.ContainsKey(ZIPFIAN_CONST_PROPERTY)) {
       double zipfian_const = std::stod(p.GetProperty(ZIPFIAN_CONST_PROPERTY));
       key_chooser_ = new ScrambledZipfianGenerator(0, record_count_ + new_keys - 1, zipfian_const);
@@ -275,6 +278,17 @@ void CoreWorkload::BuildSingleValueOfLen(std::vector<ycsbc::DB::Field> &values,
   std::generate_n(std::back_inserter(field.second), val_len, [&]() { return byte_generator.Next(); });
 }
 
+void CoreWorkload::BuildValuesOfLen(std::vector<ycsbc::DB::Field> &values, const int val_len) {
+  for (int i = 0; i < field_count_; ++i) {
+    values.push_back(DB::Field());
+    ycsbc::DB::Field &field = values.back();
+    field.first.append(field_prefix_).append(std::to_string(i));
+    field.second.reserve(val_len);
+    RandomByteGenerator byte_generator;
+    std::generate_n(std::back_inserter(field.second), val_len, [&]() { return byte_generator.Next(); });
+  }
+}
+
 uint64_t CoreWorkload::NextTransactionKeyNum() {
   uint64_t key_num;
   do {
@@ -324,6 +338,110 @@ bool CoreWorkload::DoTransaction(DB &db, ThreadState *_state) {
   return (status == DB::kOK);
 }
 
+void CoreWorkload::DoInsertAsync(DB &db, ThreadState *_state, DoneCallback done) {
+  AsyncOp *op = new AsyncOp();
+  op->op = INSERT;
+  op->ack = false;
+  op->key = BuildKeyName(insert_key_sequence_->Next());
+  if (write_all_fields()) {
+    BuildValues(op->values);
+  } else {
+    BuildSingleValue(op->values);
+  }
+  SubmitAsync(db, op, std::move(done));
+}
+
+void CoreWorkload::DoTransactionAsync(DB &db, ThreadState *_state, DoneCallback done) {
+  AsyncOp *op = new AsyncOp();
+  op->op = op_chooser_.Next();
+  op->ack = false;
+  switch (op->op) {
+    case READ:
+      op->key = BuildKeyName(NextTransactionKeyNum());
+      if (!read_all_fields()) {
+        op->fields.push_back(NextFieldName());
+      }
+      break;
+    case SCAN:
+      op->key = BuildKeyName(NextTransactionKeyNum());
+      op->scan_len = scan_len_chooser_->Next();
+      if (!read_all_fields()) {
+        op->fields.push_back(NextFieldName());
+      }
+      break;
+    case UPDATE:
+      op->key = BuildKeyName(NextTransactionKeyNum());
+      if (write_all_fields()) {
+        BuildValues(op->values);
+      } else {
+        BuildSingleValue(op->values);
+      }
+      break;
+    case READMODIFYWRITE:
+      op->key = BuildKeyName(NextTransactionKeyNum());
+      if (!read_all_fields()) {
+        op->fields.push_back(NextFieldName());
+      }
+      if (write_all_fields()) {
+        BuildValues(op->values);
+      } else {
+        BuildSingleValue(op->values);
+      }
+      break;
+    case INSERT:
+      op->ack_key_num = transaction_insert_key_sequence_->Next();
+      op->ack = true;
+      op->key = BuildKeyName(op->ack_key_num);
+      if (write_all_fields()) {
+        BuildValues(op->values);
+      } else {
+        BuildSingleValue(op->values);
+      }
+      break;
+    case RDIDX:
+      delete op;
+      done(true);
+      return;
+    default:
+      delete op;
+      throw utils::Exception("Operation request is not recognized!");
+  }
+  SubmitAsync(db, op, std::move(done));
+}
+
+void CoreWorkload::SubmitAsync(DB &db, AsyncOp *op, DoneCallback done) {
+  const std::vector<std::string> *fields = op->fields.empty() ? NULL : &op->fields;
+  auto finish = [this, op, done = std::move(done)](DB::Status s) {
+    if (op->ack) {
+      transaction_insert_key_sequence_->Acknowledge(op->ack_key_num);
+    }
+    delete op;
+    done(s == DB::kOK);
+  };
+  switch (op->op) {
+    case READ:
+      db.ReadAsync(table_name_, op->key, fields, op->result, std::move(finish));
+      break;
+    case SCAN:
+      db.ScanAsync(table_name_, op->key, op->scan_len, fields, op->scan_result, std::move(finish));
+      break;
+    case UPDATE:
+      db.UpdateAsync(table_name_, op->key, op->values, std::move(finish));
+      break;
+    case INSERT:
+      db.InsertAsync(table_name_, op->key, op->values, std::move(finish));
+      break;
+    case READMODIFYWRITE:
+      db.ReadAsync(table_name_, op->key, fields, op->result,
+                   [this, &db, op, finish = std::move(finish)](DB::Status) mutable {
+        db.UpdateAsync(table_name_, op->key, op->values, std::move(finish));
+      });
+      break;
+    default:
+      throw utils::Exception("Operation request is not recognized!");
+  }
+}
+
 DB::Status CoreWorkload::TransactionRead(DB &db) {
   uint64_t key_num = NextTransactionKeyNum();
   const std::string key = BuildKeyName(key_num);
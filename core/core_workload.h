@@ -10,6 +10,7 @@
 #ifndef YCSB_C_CORE_WORKLOAD_H_
 #define YCSB_C_CORE_WORKLOAD_H_
 
+#include <functional>
 #include <vector>
 #include <string>
 #include "db.h"
@@ -30,6 +31,8 @@ enum Operation {
   READMODIFYWRITE,
   DELETE,
   RDIDX,
+  COMMIT,
+  ABORT,
   INSERT_FAILED,
   READ_FAILED,
   UPDATE_FAILED,
@@ -37,6 +40,7 @@ enum Operation {
   READMODIFYWRITE_FAILED,
   DELETE_FAILED,
   RDIDX_FAILED,
+  COMMIT_FAILED,
   MAXOPTYPE
 };
 
@@ -201,6 +205,16 @@ class CoreWorkload {
   virtual bool DoInsert(DB &db, ThreadState *state);
   virtual bool DoTransaction(DB &db, ThreadState *state);
 
+  ///
+  /// Asynchronous counterparts of DoInsert/DoTransaction, used by the client
+  /// thread when it keeps more than one operation in flight. done(ok) runs
+  /// once the operation completes. Workloads that override DoInsert or
+  /// DoTransaction without an async path must override these to forward.
+  ///
+  using DoneCallback = std::function<void(bool)>;
+  virtual void DoInsertAsync(DB &db, ThreadState *state, DoneCallback done);
+  virtual void DoTransactionAsync(DB &db, ThreadState *state, DoneCallback done);
+
   bool read_all_fields() const { return read_all_fields_; }
   bool write_all_fields() const { return write_all_fields_; }
 
@@ -226,6 +240,7 @@ class CoreWorkload {
   void BuildValues(std::vector<DB::Field> &values);
   void BuildSingleValue(std::vector<DB::Field> &update);
   void BuildSingleValueOfLen(std::vector<ycsbc::DB::Field> &values, const int val_len);
+  void BuildValuesOfLen(std::vector<ycsbc::DB::Field> &values, const int val_len);
 
   uint64_t NextTransactionKeyNum();
   std::string NextFieldName();
@@ -237,6 +252,22 @@ class CoreWorkload {
   DB::Status TransactionInsert(DB &db);
   DB::Status TransactionReadIdx(DB &db);
 
+  ///
+  /// An operation in flight; owns the buffers handed to the DB until completion.
+  ///
+  struct AsyncOp {
+    Operation op;
+    std::string key;
+    uint64_t ack_key_num;  // acknowledged on completion if ack is set
+    bool ack;
+    int scan_len;
+    std::vector<std::string> fields;  // empty for all fields
+    std::vector<DB::Field> values;
+    std::vector<DB::Field> result;
+    std::vector<std::vector<DB::Field>> scan_result;
+  };
+  void SubmitAsync(DB &db, AsyncOp *op, DoneCallback done);
+
   std::string table_name_;
   int field_count_;
   std::string field_prefix_;
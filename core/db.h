@@ -11,9 +11,14 @@
 
 #include "utils/properties.h"
 
+#include <functional>
 #include <vector>
 #include <string>
 
+namespace YAML {
+class Node;
+}
+
 namespace ycsbc {
 
 ///
@@ -106,10 +111,81 @@ class DB {
   ///
   virtual Status ReadIdx(const uint64_t idx, std::string &data) = 0;
 
+  ///
+  /// Starts a transaction. Operations of this instance run in it until
+  /// CommitTransaction() or AbortTransaction().
+  ///
+  /// @return Zero on success, kNotImplemented if the binding has no transactions.
+  ///
+  virtual Status BeginTransaction() { return kNotImplemented; }
+  ///
+  /// Commits the current transaction.
+  ///
+  /// @return Zero on success, or kError if the transaction was aborted,
+  ///         e.g. on a write conflict.
+  ///
+  virtual Status CommitTransaction() { return kNotImplemented; }
+  ///
+  /// Rolls back the current transaction, e.g. after an operation in it
+  /// failed on a lock timeout or a conflict.
+  ///
+  virtual Status AbortTransaction() { return kNotImplemented; }
+
+  ///
+  /// Completion callback of an asynchronous operation.
+  ///
+  using Callback = std::function<void(Status)>;
+
+  ///
+  /// Asynchronous variants of the operations above. The arguments must stay
+  /// alive until the callback runs. Callbacks run on the submitting thread,
+  /// either inside the *Async call itself or inside Poll(). The defaults
+  /// complete inline through the synchronous methods; natively asynchronous
+  /// bindings override them together with Poll().
+  ///
+  virtual void ReadAsync(const std::string &table, const std::string &key,
+                         const std::vector<std::string> *fields,
+                         std::vector<Field> &result, Callback cb) {
+    cb(Read(table, key, fields, result));
+  }
+  virtual void ScanAsync(const std::string &table, const std::string &key,
+                         int record_count, const std::vector<std::string> *fields,
+                         std::vector<std::vector<Field>> &result, Callback cb) {
+    cb(Scan(table, key, record_count, fields, result));
+  }
+  virtual void UpdateAsync(const std::string &table, const std::string &key,
+                           std::vector<Field> &values, Callback cb) {
+    cb(Update(table, key, values));
+  }
+  virtual void InsertAsync(const std::string &table, const std::string &key,
+                           std::vector<Field> &values, Callback cb) {
+    cb(Insert(table, key, values));
+  }
+  virtual void DeleteAsync(const std::string &table, const std::string &key, Callback cb) {
+    cb(Delete(table, key));
+  }
+  ///
+  /// Makes progress on outstanding asynchronous operations, running the
+  /// callbacks of those that completed.
+  ///
+  /// @return The number of completed operations.
+  ///
+  virtual int Poll() { return 0; }
+
   virtual ~DB() { }
 
   virtual bool ReInitBeforeTransaction() { return false; }
 
+  ///
+  /// Database-side counters for the periodic status line, reporting what
+  /// changed since the previous call. Empty if the binding has none.
+  ///
+  virtual std::string GetStatusMsg() { return ""; }
+  ///
+  /// Adds database-side statistics of the finished phase to the run summary.
+  ///
+  virtual void EmitStats(YAML::Node &node) { }
+
   void SetProps(utils::Properties *props) {
     props_ = props;
   }
@@ -8,6 +8,7 @@
 #ifndef YCSB_C_DB_WRAPPER_H_
 #define YCSB_C_DB_WRAPPER_H_
 
+#include <chrono>
 #include <string>
 #include <vector>
 
@@ -98,9 +99,64 @@ class DBWrapper : public DB {
     }
     return s;
   }
+  Status BeginTransaction() {
+    return db_->BeginTransaction();
+  }
+  Status CommitTransaction() {
+    timer_.Start();
+    Status s = db_->CommitTransaction();
+    uint64_t elapsed = timer_.End();
+    if (s == kOK) {
+      measurements_->Report(COMMIT, elapsed);
+    } else {
+      measurements_->Report(COMMIT_FAILED, elapsed);
+    }
+    return s;
+  }
+  Status AbortTransaction() {
+    timer_.Start();
+    Status s = db_->AbortTransaction();
+    measurements_->Report(ABORT, timer_.End());
+    return s;
+  }
+
+  void ReadAsync(const std::string &table, const std::string &key,
+                 const std::vector<std::string> *fields, std::vector<Field> &result, Callback cb) {
+    db_->ReadAsync(table, key, fields, result, Timed(READ, READ_FAILED, std::move(cb)));
+  }
+  void ScanAsync(const std::string &table, const std::string &key, int record_count,
+                 const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result,
+                 Callback cb) {
+    db_->ScanAsync(table, key, record_count, fields, result, Timed(SCAN, SCAN_FAILED, std::move(cb)));
+  }
+  void UpdateAsync(const std::string &table, const std::string &key, std::vector<Field> &values,
+                   Callback cb) {
+    db_->UpdateAsync(table, key, values, Timed(UPDATE, UPDATE_FAILED, std::move(cb)));
+  }
+  void InsertAsync(const std::string &table, const std::string &key, std::vector<Field> &values,
+                   Callback cb) {
+    db_->InsertAsync(table, key, values, Timed(INSERT, INSERT_FAILED, std::move(cb)));
+  }
+  void DeleteAsync(const std::string &table, const std::string &key, Callback cb) {
+    db_->DeleteAsync(table, key, Timed(DELETE, DELETE_FAILED, std::move(cb)));
+  }
+  int Poll() { return db_->Poll(); }
 
   bool ReInitBeforeTransaction() override { return db_->ReInitBeforeTransaction(); }
+  std::string GetStatusMsg() override { return db_->GetStatusMsg(); }
+  void EmitStats(YAML::Node &node) override { db_->EmitStats(node); }
  private:
+  // latency of an async op spans submission to completion
+  Callback Timed(Operation op, Operation failed_op, Callback cb) {
+    auto start = std::chrono::high_resolution_clock::now();
+    return [this, op, failed_op, start, cb = std::move(cb)](Status s) {
+      uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::high_resolution_clock::now() - start).count();
+      measurements_->Report(s == kOK ? op : failed_op, elapsed);
+      cb(s);
+    };
+  }
+
   DB *db_;
   Measurements *measurements_;
   utils::Timer<uint64_t, std::nano> timer_;
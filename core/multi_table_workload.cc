@@ -0,0 +1,150 @@
+//
+//  multi_table_workload.cc
+//  YCSB-cpp
+//
+
+#include "multi_table_workload.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "workload_factory.h"
+
+namespace ycsbc {
+
+const std::string MultiTableWorkload::TABLE_COUNT_PROPERTY = "tablecount";
+const std::string MultiTableWorkload::TABLE_COUNT_DEFAULT = "1";
+
+const std::string MultiTableWorkload::TABLE_PROPERTY_PREFIX = "table.";
+
+const std::string MultiTableWorkload::TABLE_NAME_PROPERTY = "name";
+
+const std::string MultiTableWorkload::TABLE_PROPORTION_PROPERTY = "proportion";
+const std::string MultiTableWorkload::TABLE_PROPORTION_DEFAULT = "1";
+
+std::vector<std::string> MultiTableWorkload::TableNames(const utils::Properties &p) {
+  std::vector<std::string> names;
+  if (!p.ContainsKey(TABLE_COUNT_PROPERTY)) {
+    return names;
+  }
+  const int table_count = std::stoi(p[TABLE_COUNT_PROPERTY]);
+  const std::string base = p.GetProperty(TABLENAME_PROPERTY, TABLENAME_DEFAULT);
+  for (int i = 0; i < table_count; ++i) {
+    const std::string prefix = TABLE_PROPERTY_PREFIX + std::to_string(i) + ".";
+    names.push_back(p.GetProperty(prefix + TABLE_NAME_PROPERTY, base + std::to_string(i)));
+  }
+  return names;
+}
+
+utils::Properties MultiTableWorkload::TableProperties(const utils::Properties &p, int table) {
+  utils::Properties table_props = p;
+  const std::string prefix = TABLE_PROPERTY_PREFIX + std::to_string(table) + ".";
+  const std::map<std::string, std::string> all = table_props.ToMap();
+  for (const auto &kv : all) {
+    if (kv.first.compare(0, prefix.size(), prefix) == 0) {
+      table_props.SetProperty(kv.first.substr(prefix.size()), kv.second);
+    }
+  }
+  table_props.SetProperty(TABLENAME_PROPERTY, TableNames(p)[table]);
+  return table_props;
+}
+
+MultiTableWorkload::~MultiTableWorkload() {
+  for (CoreWorkload *table : tables_) {
+    delete table;
+  }
+}
+
+void MultiTableWorkload::Init(const utils::Properties &p) {
+  utils::Properties props = p;
+  if (!props.ContainsKey(TABLE_COUNT_PROPERTY)) {
+    props.SetProperty(TABLE_COUNT_PROPERTY, TABLE_COUNT_DEFAULT);
+  }
+  const std::vector<std::string> names = TableNames(props);
+  if (names.empty()) {
+    throw utils::Exception(TABLE_COUNT_PROPERTY + " must be at least 1");
+  }
+
+  // tables without their own recordcount share what the others leave over
+  const uint64_t total = std::stoull(props[RECORD_COUNT_PROPERTY]);
+  std::vector<uint64_t> counts(names.size(), 0);
+  uint64_t assigned = 0;
+  size_t unassigned = 0;
+  for (size_t i = 0; i < names.size(); ++i) {
+    const std::string key = TABLE_PROPERTY_PREFIX + std::to_string(i) + "." + RECORD_COUNT_PROPERTY;
+    if (props.ContainsKey(key)) {
+      counts[i] = std::stoull(props[key]);
+      assigned += counts[i];
+    } else {
+      unassigned++;
+    }
+  }
+  if (assigned > total || (unassigned == 0 && assigned != total)) {
+    throw utils::Exception("table.<i>.recordcount must add up to " + RECORD_COUNT_PROPERTY + "=" +
+                           std::to_string(total));
+  }
+  const uint64_t rest = total - assigned;
+  for (size_t i = 0, k = 0; i < names.size(); ++i) {
+    const std::string key = TABLE_PROPERTY_PREFIX + std::to_string(i) + "." + RECORD_COUNT_PROPERTY;
+    if (!props.ContainsKey(key)) {
+      counts[i] = rest / unassigned + (k < rest % unassigned);
+      k++;
+    }
+    if (counts[i] == 0) {
+      throw utils::Exception("table " + names[i] + " has no records");
+    }
+  }
+
+  load_left_.reset(new std::atomic<int64_t>[names.size()]);
+  for (size_t i = 0; i < names.size(); ++i) {
+    utils::Properties table_props = TableProperties(props, i);
+    table_props.SetProperty(RECORD_COUNT_PROPERTY, std::to_string(counts[i]));
+    CoreWorkload *table = new CoreWorkload;
+    tables_.push_back(table);
+    table->Init(table_props);
+
+    double proportion = std::stod(table_props.GetProperty(TABLE_PROPORTION_PROPERTY,
+                                                          TABLE_PROPORTION_DEFAULT));
+    if (proportion > 0) {
+      table_chooser_.AddValue(i, proportion);
+    }
+    load_chooser_.AddValue(i, counts[i]);
+    load_left_[i] = counts[i];
+  }
+}
+
+CoreWorkload *MultiTableWorkload::NextLoadTable() {
+  const size_t table = load_chooser_.Next();
+  for (size_t k = 0; k < tables_.size(); ++k) {
+    const size_t i = (table + k) % tables_.size();
+    if (load_left_[i].fetch_sub(1, std::memory_order_relaxed) > 0) {
+      return tables_[i];
+    }
+  }
+  // more load operations than records, keep the recordcount mix
+  return tables_[table];
+}
+
+bool MultiTableWorkload::DoInsert(DB &db, ThreadState *state) {
+  return NextLoadTable()->DoInsert(db, state);
+}
+
+bool MultiTableWorkload::DoTransaction(DB &db, ThreadState *state) {
+  return tables_[table_chooser_.Next()]->DoTransaction(db, state);
+}
+
+void MultiTableWorkload::DoInsertAsync(DB &db, ThreadState *state, DoneCallback done) {
+  NextLoadTable()->DoInsertAsync(db, state, std::move(done));
+}
+
+void MultiTableWorkload::DoTransactionAsync(DB &db, ThreadState *state, DoneCallback done) {
+  tables_[table_chooser_.Next()]->DoTransactionAsync(db, state, std::move(done));
+}
+
+const bool registered = ycsbc::WorkloadFactory::RegisterWorkload(
+  "com.yahoo.ycsb.workloads.MultiTableWorkload",
+  []() { return dynamic_cast<CoreWorkload *>(new MultiTableWorkload); }
+);
+
+} // ycsbc
@@ -0,0 +1,82 @@
+//
+//  multi_table_workload.h
+//  YCSB-cpp
+//
+
+#ifndef YCSB_C_MULTI_TABLE_WORKLOAD_H_
+#define YCSB_C_MULTI_TABLE_WORKLOAD_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core_workload.h"
+
+namespace ycsbc {
+
+///
+/// Runs a CoreWorkload per table. Table i is configured by the global
+/// properties overlaid with every "table.<i>.<prop>" key, so each table can
+/// have its own name, recordcount, fieldcount, fieldlength, field_len_dist,
+/// requestdistribution, operation mix and so on. Operations are spread over
+/// the tables by "table.<i>.proportion"; the load phase interleaves the
+/// tables and inserts exactly each table's recordcount.
+///
+/// Bindings that support several tables (rocksdb column families,
+/// wiredtiger tables, lmdb named databases) create them from TableNames().
+///
+class MultiTableWorkload : public CoreWorkload {
+ public:
+  ///
+  /// The name of the property for the number of tables.
+  ///
+  static const std::string TABLE_COUNT_PROPERTY;
+  static const std::string TABLE_COUNT_DEFAULT;
+
+  ///
+  /// Prefix of the per-table properties, "table.<i>.".
+  ///
+  static const std::string TABLE_PROPERTY_PREFIX;
+
+  ///
+  /// The name of the per-table property for the table name.
+  /// Defaults to "<table><i>", e.g. usertable0.
+  ///
+  static const std::string TABLE_NAME_PROPERTY;
+
+  ///
+  /// The name of the per-table property for the share of transaction
+  /// operations that go to the table.
+  ///
+  static const std::string TABLE_PROPORTION_PROPERTY;
+  static const std::string TABLE_PROPORTION_DEFAULT;
+
+  ///
+  /// Table names configured by p, or empty when tablecount is not set.
+  ///
+  static std::vector<std::string> TableNames(const utils::Properties &p);
+
+  MultiTableWorkload() {}
+  ~MultiTableWorkload() override;
+
+  void Init(const utils::Properties &p) override;
+
+  bool DoInsert(DB &db, ThreadState *state) override;
+  bool DoTransaction(DB &db, ThreadState *state) override;
+  void DoInsertAsync(DB &db, ThreadState *state, DoneCallback done) override;
+  void DoTransactionAsync(DB &db, ThreadState *state, DoneCallback done) override;
+
+ protected:
+  static utils::Properties TableProperties(const utils::Properties &p, int table);
+  CoreWorkload *NextLoadTable();
+
+  std::vector<CoreWorkload *> tables_;
+  DiscreteGenerator<size_t> table_chooser_;
+  DiscreteGenerator<size_t> load_chooser_;
+  std::unique_ptr<std::atomic<int64_t>[]> load_left_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_MULTI_TABLE_WORKLOAD_H_
@@ -39,6 +39,16 @@ bool PureInsertWorkload::DoInsert(DB &db, ThreadState *state) {
 
 bool PureInsertWorkload::DoTransaction(DB &db, ThreadState *state) { return DoInsert(db, state); }
 
+void PureInsertWorkload::DoInsertAsync(DB &db, ThreadState *state, DoneCallback done) {
+  InsertThreadState *insert_state = dynamic_cast<InsertThreadState *>(state);
+  AsyncOp *op = new AsyncOp();
+  op->op = INSERT;
+  op->ack = false;
+  op->key = insert_state->GetNextKey();
+  BuildSingleValueOfLen(op->values, value_len);
+  SubmitAsync(db, op, std::move(done));
+}
+
 InsertThreadState::InsertThreadState(const utils::Properties &p, const int mythreadid, const int threadcount,
                                      const int num_ops)
     : cur_workload(nullptr), workload_i(0), offset(0) {
@@ -24,6 +24,10 @@ class PureInsertWorkload : public CoreWorkload {
 
   bool DoInsert(DB &db, ThreadState *state) override;
   bool DoTransaction(DB &db, ThreadState *state) override;
+  void DoInsertAsync(DB &db, ThreadState *state, DoneCallback done) override;
+  void DoTransactionAsync(DB &db, ThreadState *state, DoneCallback done) override {
+    DoInsertAsync(db, state, std::move(done));
+  }
 
  protected:
   int value_len;
@@ -0,0 +1,160 @@
+//
+//  trace_file.cc
+//  YCSB-cpp
+//
+
+#include "trace_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include "utils/utils.h"
+
+namespace ycsbc {
+
+const char TraceHeader::kMagic[8] = {'Y', 'C', 'S', 'B', 'T', 'R', 'C', '\0'};
+const uint32_t TraceHeader::kVersion = 1;
+
+std::string TraceFileName(const std::string &dir, bool is_loading, int thread_id) {
+  return dir + (is_loading ? "/load." : "/run.") + std::to_string(thread_id) + ".trace";
+}
+
+TraceWriter::TraceWriter(const std::string &path, size_t buffer_size)
+    : buffer_size_(buffer_size), active_(buffer_size), pending_(buffer_size), active_len_(0),
+      pending_len_(0), has_pending_(false), closing_(false) {
+  fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd_ < 0) {
+    throw utils::Exception("unable to open trace file " + path + ": " + std::strerror(errno));
+  }
+  flusher_ = std::thread(&TraceWriter::FlushLoop, this);
+}
+
+TraceWriter::~TraceWriter() {
+  Close();
+}
+
+void TraceWriter::Append(const void *data, size_t len) {
+  const char *p = static_cast<const char *>(data);
+  while (len > 0) {
+    size_t n = std::min(len, buffer_size_ - active_len_);
+    std::memcpy(active_.data() + active_len_, p, n);
+    active_len_ += n;
+    p += n;
+    len -= n;
+    if (active_len_ == buffer_size_) {
+      HandOff();
+    }
+  }
+}
+
+void TraceWriter::AppendHeader() {
+  TraceHeader header;
+  std::memcpy(header.magic, TraceHeader::kMagic, sizeof(header.magic));
+  header.version = TraceHeader::kVersion;
+  header.record_size = sizeof(TraceRecord);
+  Append(&header, sizeof(header));
+}
+
+void TraceWriter::HandOff() {
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this] { return !has_pending_; });
+  active_.swap(pending_);
+  pending_len_ = active_len_;
+  has_pending_ = true;
+  active_len_ = 0;
+  cv_.notify_all();
+}
+
+void TraceWriter::FlushLoop() {
+  std::unique_lock<std::mutex> lock(mu_);
+  while (true) {
+    cv_.wait(lock, [this] { return has_pending_ || closing_; });
+    if (!has_pending_) {
+      return;
+    }
+    lock.unlock();
+    const char *p = pending_.data();
+    size_t left = pending_len_;
+    while (left > 0) {
+      ssize_t n = ::write(fd_, p, left);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        std::cerr << "trace write failed: " << std::strerror(errno) << std::endl;
+        exit(1);
+      }
+      p += n;
+      left -= n;
+    }
+    lock.lock();
+    has_pending_ = false;
+    cv_.notify_all();
+  }
+}
+
+void TraceWriter::Close() {
+  if (fd_ < 0) {
+    return;
+  }
+  if (active_len_ > 0) {
+    HandOff();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    closing_ = true;
+    cv_.notify_all();
+  }
+  flusher_.join();
+  ::close(fd_);
+  fd_ = -1;
+}
+
+TraceReader::TraceReader(const std::string &path) : map_(nullptr), map_len_(0), records_(nullptr), count_(0) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw utils::Exception("unable to open trace file " + path + ": " + std::strerror(errno));
+  }
+  struct stat status;
+  if (::fstat(fd, &status) < 0) {
+    ::close(fd);
+    throw utils::Exception("unable to stat trace file " + path);
+  }
+  map_len_ = status.st_size;
+  if (map_len_ < sizeof(TraceHeader)) {
+    ::close(fd);
+    throw utils::Exception("truncated trace file " + path);
+  }
+  map_ = ::mmap(nullptr, map_len_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (map_ == MAP_FAILED) {
+    map_ = nullptr;
+    throw utils::Exception("unable to mmap trace file " + path);
+  }
+  ::madvise(map_, map_len_, MADV_SEQUENTIAL);
+
+  const TraceHeader *header = static_cast<const TraceHeader *>(map_);
+  if (std::memcmp(header->magic, TraceHeader::kMagic, sizeof(header->magic)) != 0 ||
+      header->version != TraceHeader::kVersion || header->record_size != sizeof(TraceRecord)) {
+    ::munmap(map_, map_len_);
+    map_ = nullptr;
+    throw utils::Exception("not a binary trace file: " + path);
+  }
+  records_ = reinterpret_cast<const TraceRecord *>(static_cast<const char *>(map_) + sizeof(TraceHeader));
+  count_ = (map_len_ - sizeof(TraceHeader)) / sizeof(TraceRecord);
+}
+
+TraceReader::~TraceReader() {
+  if (map_) {
+    ::munmap(map_, map_len_);
+  }
+}
+
+} // ycsbc
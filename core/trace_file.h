@@ -0,0 +1,101 @@
+//
+//  trace_file.h
+//  YCSB-cpp
+//
+
+#ifndef YCSB_C_TRACE_FILE_H_
+#define YCSB_C_TRACE_FILE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ycsbc {
+
+///
+/// One generated operation, as drawn by CoreWorkload. Keys are stored as key
+/// numbers, so a replay must use the same insertorder and zeropadding as the
+/// capture. Value bytes are not stored, only their length.
+///
+struct TraceRecord {
+  uint64_t key_num;
+  uint32_t scan_len;   // SCAN only
+  uint32_t value_len;  // INSERT/UPDATE/READMODIFYWRITE, applied to every written field (see TracePeek::Init)
+  int32_t field;       // field index to read, or -1 for all fields
+  uint8_t op;          // ycsbc::Operation
+  uint8_t pad[3];
+};
+
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord must stay 24 bytes on disk");
+
+struct TraceHeader {
+  static const char kMagic[8];
+  static const uint32_t kVersion;
+
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+};
+
+///
+/// Per-thread trace file name, e.g. "<dir>/run.3.trace".
+///
+std::string TraceFileName(const std::string &dir, bool is_loading, int thread_id);
+
+///
+/// Append-only file writer. Appends go to an in-memory buffer; full buffers
+/// are handed to a background thread which writes them out, so the caller
+/// only blocks when the writer falls a full buffer behind.
+///
+class TraceWriter {
+ public:
+  TraceWriter(const std::string &path, size_t buffer_size);
+  ~TraceWriter();
+
+  void Append(const void *data, size_t len);
+  void Append(const TraceRecord &rec) { Append(&rec, sizeof(rec)); }
+  void AppendHeader();
+  void Close();
+
+ private:
+  void HandOff();
+  void FlushLoop();
+
+  int fd_;
+  const size_t buffer_size_;
+  std::vector<char> active_;
+  std::vector<char> pending_;
+  size_t active_len_;
+  size_t pending_len_;
+  bool has_pending_;
+  bool closing_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::thread flusher_;
+};
+
+///
+/// Read-only mapping of a binary trace written with TraceWriter.
+///
+class TraceReader {
+ public:
+  explicit TraceReader(const std::string &path);
+  ~TraceReader();
+
+  size_t size() const { return count_; }
+  const TraceRecord &operator[](size_t i) const { return records_[i]; }
+
+ private:
+  void *map_;
+  size_t map_len_;
+  const TraceRecord *records_;
+  size_t count_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_TRACE_FILE_H_
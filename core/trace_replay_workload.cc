@@ -0,0 +1,130 @@
+//
+//  trace_replay_workload.cc
+//  YCSB-cpp
+//
+
+#include "trace_replay_workload.h"
+
+#include <string>
+#include <vector>
+
+#include "workload_factory.h"
+
+namespace ycsbc {
+
+const std::string TraceReplayWorkload::DIR_PROPERTY = "tracereplay.dir";
+const std::string TraceReplayWorkload::DIR_DEFAULT = ".";
+
+void TraceReplayWorkload::Init(const utils::Properties &p) {
+  CoreWorkload::Init(p);
+  dir_ = p.GetProperty(DIR_PROPERTY, DIR_DEFAULT);
+}
+
+ThreadState *TraceReplayWorkload::InitThread(const utils::Properties &p, const int mythreadid,
+                                             const int threadcount, const int num_ops) {
+  return new ReplayThreadState(mythreadid);
+}
+
+const TraceRecord &TraceReplayWorkload::NextRecord(ThreadState *state, bool is_loading) {
+  ReplayThreadState *replay_state = static_cast<ReplayThreadState *>(state);
+  if (!replay_state->reader_) {
+    replay_state->reader_.reset(new TraceReader(TraceFileName(dir_, is_loading, replay_state->thread_id_)));
+    if (replay_state->reader_->size() == 0) {
+      throw utils::Exception("empty trace file for thread " + std::to_string(replay_state->thread_id_));
+    }
+  }
+  if (replay_state->pos_ == replay_state->reader_->size()) {
+    replay_state->pos_ = 0;
+  }
+  return (*replay_state->reader_)[replay_state->pos_++];
+}
+
+void TraceReplayWorkload::BuildReplayValues(std::vector<DB::Field> &values, uint32_t len) {
+  if (write_all_fields()) {
+    BuildValuesOfLen(values, len);
+  } else {
+    BuildSingleValueOfLen(values, len);
+  }
+}
+
+DB::Status TraceReplayWorkload::Replay(DB &db, const TraceRecord &rec) {
+  const std::string key = BuildKeyName(rec.key_num);
+  std::vector<std::string> fields;
+  if (rec.field >= 0) {
+    fields.push_back(std::string(field_prefix_).append(std::to_string(rec.field)));
+  }
+  std::vector<std::string> *read_fields = rec.field >= 0 ? &fields : NULL;
+
+  switch (rec.op) {
+    case INSERT: {
+      std::vector<DB::Field> values;
+      BuildReplayValues(values, rec.value_len);
+      return db.Insert(table_name_, key, values);
+    }
+    case READ: {
+      std::vector<DB::Field> result;
+      return db.Read(table_name_, key, read_fields, result);
+    }
+    case UPDATE: {
+      std::vector<DB::Field> values;
+      BuildReplayValues(values, rec.value_len);
+      return db.Update(table_name_, key, values);
+    }
+    case SCAN: {
+      std::vector<std::vector<DB::Field>> result;
+      return db.Scan(table_name_, key, rec.scan_len, read_fields, result);
+    }
+    case READMODIFYWRITE: {
+      std::vector<DB::Field> result;
+      db.Read(table_name_, key, read_fields, result);
+      std::vector<DB::Field> values;
+      BuildReplayValues(values, rec.value_len);
+      return db.Update(table_name_, key, values);
+    }
+    case RDIDX:
+      return DB::kOK;
+    default:
+      throw utils::Exception("Operation request is not recognized!");
+  }
+}
+
+bool TraceReplayWorkload::DoInsert(DB &db, ThreadState *state) {
+  return Replay(db, NextRecord(state, true)) == DB::kOK;
+}
+
+bool TraceReplayWorkload::DoTransaction(DB &db, ThreadState *state) {
+  return Replay(db, NextRecord(state, false)) == DB::kOK;
+}
+
+void TraceReplayWorkload::ReplayAsync(DB &db, const TraceRecord &rec, DoneCallback done) {
+  if (rec.op == RDIDX) {
+    done(true);
+    return;
+  }
+  AsyncOp *op = new AsyncOp();
+  op->op = static_cast<Operation>(rec.op);
+  op->ack = false;
+  op->key = BuildKeyName(rec.key_num);
+  op->scan_len = rec.scan_len;
+  if (rec.field >= 0) {
+    op->fields.push_back(std::string(field_prefix_).append(std::to_string(rec.field)));
+  }
+  if (rec.op == INSERT || rec.op == UPDATE || rec.op == READMODIFYWRITE) {
+    BuildReplayValues(op->values, rec.value_len);
+  }
+  SubmitAsync(db, op, std::move(done));
+}
+
+void TraceReplayWorkload::DoInsertAsync(DB &db, ThreadState *state, DoneCallback done) {
+  ReplayAsync(db, NextRecord(state, true), std::move(done));
+}
+
+void TraceReplayWorkload::DoTransactionAsync(DB &db, ThreadState *state, DoneCallback done) {
+  ReplayAsync(db, NextRecord(state, false), std::move(done));
+}
+
+const bool registered = WorkloadFactory::RegisterWorkload("com.yahoo.ycsb.workloads.TraceReplayWorkload", []() {
+  return dynamic_cast<CoreWorkload *>(new TraceReplayWorkload);
+});
+
+} // ycsbc
@@ -0,0 +1,64 @@
+//
+//  trace_replay_workload.h
+//  YCSB-cpp
+//
+
+#ifndef YCSB_C_TRACE_REPLAY_WORKLOAD_H_
+#define YCSB_C_TRACE_REPLAY_WORKLOAD_H_
+
+#include <memory>
+#include <string>
+
+#include "core_workload.h"
+#include "trace_file.h"
+
+namespace ycsbc {
+
+///
+/// Replays binary traces captured by TracePeek (tracepeek.format=binary).
+/// Thread N reads <tracereplay.dir>/load.N.trace during load and
+/// run.N.trace during the transaction phase, wrapping around at the end.
+/// Key names are rebuilt with this run's insertorder/zeropadding.
+///
+class TraceReplayWorkload : public CoreWorkload {
+ public:
+  static const std::string DIR_PROPERTY;
+  static const std::string DIR_DEFAULT;
+
+  TraceReplayWorkload() {}
+  ~TraceReplayWorkload() override {}
+
+  void Init(const utils::Properties &p) override;
+  ThreadState *InitThread(const utils::Properties &p, const int mythreadid, const int threadcount,
+                          const int num_ops) override;
+
+  bool DoInsert(DB &db, ThreadState *state) override;
+  bool DoTransaction(DB &db, ThreadState *state) override;
+  void DoInsertAsync(DB &db, ThreadState *state, DoneCallback done) override;
+  void DoTransactionAsync(DB &db, ThreadState *state, DoneCallback done) override;
+
+ protected:
+  const TraceRecord &NextRecord(ThreadState *state, bool is_loading);
+  DB::Status Replay(DB &db, const TraceRecord &rec);
+  void ReplayAsync(DB &db, const TraceRecord &rec, DoneCallback done);
+  void BuildReplayValues(std::vector<DB::Field> &values, uint32_t len);
+
+  std::string dir_;
+};
+
+class ReplayThreadState : public ThreadState {
+  friend class TraceReplayWorkload;
+
+ public:
+  ReplayThreadState(const int mythreadid) : thread_id_(mythreadid), pos_(0) {}
+  ~ReplayThreadState() override {}
+
+ protected:
+  const int thread_id_;
+  std::unique_ptr<TraceReader> reader_;
+  size_t pos_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_TRACE_REPLAY_WORKLOAD_H_
@@ -1,17 +1,130 @@
 #include "tracepeek.h"
 
+#include <cstring>
 #include <string>
 
 #include "workload_factory.h"
 
 namespace ycsbc {
 
-void TracePeek::Init(const utils::Properties &p) { CoreWorkload::Init(p); }
+const std::string TracePeek::FORMAT_PROPERTY = "tracepeek.format";
+const std::string TracePeek::FORMAT_DEFAULT = "text";
+
+const std::string TracePeek::DIR_PROPERTY = "tracepeek.dir";
+const std::string TracePeek::DIR_DEFAULT = ".";
+
+const std::string TracePeek::BUFFER_SIZE_PROPERTY = "tracepeek.buffer_size";
+const std::string TracePeek::BUFFER_SIZE_DEFAULT = "4194304";
+
+void TracePeek::Init(const utils::Properties &p) {
+  CoreWorkload::Init(p);
+
+  const std::string format = p.GetProperty(FORMAT_PROPERTY, FORMAT_DEFAULT);
+  if (format == "binary") {
+    binary_ = true;
+  } else if (format == "text") {
+    binary_ = false;
+  } else {
+    throw utils::Exception("unknown tracepeek format: " + format);
+  }
+  // a TraceRecord holds one value length for all written fields
+  if (binary_ && write_all_fields() && field_count_ > 1 &&
+      p.GetProperty(FIELD_LENGTH_DISTRIBUTION_PROPERTY, FIELD_LENGTH_DISTRIBUTION_DEFAULT) != "constant") {
+    throw utils::Exception("binary tracepeek needs a constant " + FIELD_LENGTH_DISTRIBUTION_PROPERTY +
+                           " when " + WRITE_ALL_FIELDS_PROPERTY + "=true");
+  }
+  dir_ = p.GetProperty(DIR_PROPERTY, DIR_DEFAULT);
+  buffer_size_ = std::stoull(p.GetProperty(BUFFER_SIZE_PROPERTY, BUFFER_SIZE_DEFAULT));
+}
+
+void TracePeek::NextInsertRecord(TraceRecord &rec) {
+  NextInsertRecord(rec, insert_key_sequence_->Next());
+}
+
+void TracePeek::NextInsertRecord(TraceRecord &rec, uint64_t key_num) {
+  std::memset(&rec, 0, sizeof(rec));
+  rec.op = INSERT;
+  rec.key_num = key_num;
+  rec.field = -1;
+  rec.value_len = field_len_generator_->Next();
+}
+
+void TracePeek::NextTransactionRecord(TraceRecord &rec) {
+  std::memset(&rec, 0, sizeof(rec));
+  rec.op = op_chooser_.Next();
+  rec.field = -1;
+  switch (rec.op) {
+    case READ:
+      rec.key_num = NextTransactionKeyNum();
+      if (!read_all_fields()) {
+        rec.field = field_chooser_->Next();
+      }
+      break;
+    case UPDATE:
+      rec.key_num = NextTransactionKeyNum();
+      rec.value_len = field_len_generator_->Next();
+      break;
+    case INSERT:
+      rec.key_num = transaction_insert_key_sequence_->Next();
+      rec.value_len = field_len_generator_->Next();
+      transaction_insert_key_sequence_->Acknowledge(rec.key_num);
+      break;
+    case SCAN:
+      rec.key_num = NextTransactionKeyNum();
+      rec.scan_len = scan_len_chooser_->Next();
+      if (!read_all_fields()) {
+        rec.field = field_chooser_->Next();
+      }
+      break;
+    case READMODIFYWRITE:
+      rec.key_num = NextTransactionKeyNum();
+      if (!read_all_fields()) {
+        rec.field = field_chooser_->Next();
+      }
+      rec.value_len = field_len_generator_->Next();
+      break;
+    case RDIDX:
+      break;
+    default:
+      throw utils::Exception("Operation request is not recognized!");
+  }
+}
+
+TraceWriter &TracePeek::Writer(ThreadState *state, bool is_loading) {
+  PeekThreadState *peek_state = static_cast<PeekThreadState *>(state);
+  if (!peek_state->writer_) {
+    if (binary_) {
+      peek_state->writer_.reset(
+          new TraceWriter(TraceFileName(dir_, is_loading, peek_state->thread_id_), buffer_size_));
+      peek_state->writer_->AppendHeader();
+    } else {
+      peek_state->writer_.reset(
+          new TraceWriter(dir_ + "/th" + std::to_string(peek_state->thread_id_) + ".keys", buffer_size_));
+    }
+  }
+  return *peek_state->writer_;
+}
+
+bool TracePeek::DoInsert(DB &db, ThreadState *state) {
+  if (!binary_) {
+    return CoreWorkload::DoInsert(db, state);
+  }
+  TraceRecord rec;
+  NextInsertRecord(rec);
+  Writer(state, true).Append(rec);
+  return true;
+}
 
 bool TracePeek::DoTransaction(DB &_db, ThreadState *state) {
-  uint64_t key_num = NextTransactionKeyNum();
-  PeekThreadState *peek_state = dynamic_cast<PeekThreadState *>(state);
-  peek_state->trace_fs << kOperationString[op_chooser_.Next()] << " " << key_num << std::endl;
+  TraceRecord rec;
+  NextTransactionRecord(rec);
+  if (binary_) {
+    Writer(state, false).Append(rec);
+  } else {
+    std::string line = std::string(kOperationString[rec.op]).append(" ")
+                           .append(std::to_string(rec.key_num)).append("\n");
+    Writer(state, false).Append(line.data(), line.size());
+  }
   return true;
 }
 
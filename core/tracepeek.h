@@ -1,38 +1,75 @@
 #ifndef YCSB_C_TRACEPEEK_H_
 #define YCSB_C_TRACEPEEK_H_
 
-#include <iostream>
-#include <fstream>
+#include <memory>
+#include <string>
 
 #include "core_workload.h"
+#include "trace_file.h"
 
 namespace ycsbc {
 
+///
+/// Records the operation stream instead of running it. In "text" format the
+/// run phase is written as "<OP> <keynum>" lines to th<N>.keys; in "binary"
+/// format both phases are written as TraceRecords which
+/// TraceReplayWorkload consumes. Binary capture rejects a non-constant
+/// field_len_dist with writeallfields=true, since a record stores a single
+/// value length.
+///
 class TracePeek : public CoreWorkload {
  public:
-  TracePeek() : CoreWorkload() {}
+  static const std::string FORMAT_PROPERTY;
+  static const std::string FORMAT_DEFAULT;
+
+  static const std::string DIR_PROPERTY;
+  static const std::string DIR_DEFAULT;
+
+  static const std::string BUFFER_SIZE_PROPERTY;
+  static const std::string BUFFER_SIZE_DEFAULT;
+
+  TracePeek() : CoreWorkload(), binary_(false), buffer_size_(0) {}
   ~TracePeek() override {}
 
   void Init(const utils::Properties &p) override;
+  bool DoInsert(DB &db, ThreadState *state) override;
   bool DoTransaction(DB &db, ThreadState *state) override;
+  void DoInsertAsync(DB &db, ThreadState *state, DoneCallback done) override {
+    done(DoInsert(db, state));
+  }
+  void DoTransactionAsync(DB &db, ThreadState *state, DoneCallback done) override {
+    done(DoTransaction(db, state));
+  }
   ThreadState *InitThread(const utils::Properties &p, const int mythreadid, const int threadcount,
                           const int num_ops) override;
+
+  ///
+  /// Draw the next operation exactly as CoreWorkload would run it.
+  ///
+  void NextInsertRecord(TraceRecord &rec);
+  void NextInsertRecord(TraceRecord &rec, uint64_t key_num);
+  void NextTransactionRecord(TraceRecord &rec);
+
+  using CoreWorkload::BuildKeyName;
+
+ protected:
+  TraceWriter &Writer(ThreadState *state, bool is_loading);
+
+  bool binary_;
+  std::string dir_;
+  size_t buffer_size_;
 };
 
 class PeekThreadState : public ThreadState {
   friend class TracePeek;
 
  public:
-  PeekThreadState(const int mythreadid) : trace_fs("th" + std::to_string(mythreadid) + ".keys") {
-    std::cout << "opened\n";
-  }
-  ~PeekThreadState() override {
-    trace_fs.close();
-    std::cout << "closed\n";
-  }
+  PeekThreadState(const int mythreadid) : thread_id_(mythreadid) {}
+  ~PeekThreadState() override {}
 
  protected:
-  std::ofstream trace_fs;
+  const int thread_id_;
+  std::unique_ptr<TraceWriter> writer_;
 };
 
 }  // namespace ycsbc
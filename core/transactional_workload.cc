@@ -0,0 +1,73 @@
+//
+//  transactional_workload.cc
+//  YCSB-cpp
+//
+
+#include "transactional_workload.h"
+
+#include <string>
+#include <vector>
+
+#include "workload_factory.h"
+
+namespace ycsbc {
+
+const std::string TransactionalWorkload::TXN_KEYS_PROPERTY = "txn.keys";
+const std::string TransactionalWorkload::TXN_KEYS_DEFAULT = "4";
+
+const std::string TransactionalWorkload::TXN_READ_PROPORTION_PROPERTY = "txn.readproportion";
+const std::string TransactionalWorkload::TXN_READ_PROPORTION_DEFAULT = "0.5";
+
+void TransactionalWorkload::Init(const utils::Properties &p) {
+  CoreWorkload::Init(p);
+  txn_keys_ = std::stoi(p.GetProperty(TXN_KEYS_PROPERTY, TXN_KEYS_DEFAULT));
+  txn_read_proportion_ = std::stod(p.GetProperty(TXN_READ_PROPORTION_PROPERTY, TXN_READ_PROPORTION_DEFAULT));
+  if (txn_keys_ < 1) {
+    throw utils::Exception(TXN_KEYS_PROPERTY + " must be at least 1");
+  }
+}
+
+DB::Status TransactionalWorkload::TransactionKeyRead(DB &db, const std::string &key) {
+  std::vector<DB::Field> result;
+  if (!read_all_fields()) {
+    std::vector<std::string> fields;
+    fields.push_back(NextFieldName());
+    return db.Read(table_name_, key, &fields, result);
+  } else {
+    return db.Read(table_name_, key, NULL, result);
+  }
+}
+
+bool TransactionalWorkload::DoTransaction(DB &db, ThreadState *_state) {
+  DB::Status status = db.BeginTransaction();
+  if (status == DB::kNotImplemented) {
+    throw utils::Exception("the database binding does not support transactions");
+  } else if (status != DB::kOK) {
+    return false;
+  }
+  for (int i = 0; i < txn_keys_; i++) {
+    const std::string key = BuildKeyName(NextTransactionKeyNum());
+    status = TransactionKeyRead(db, key);
+    if (status == DB::kOK && utils::ThreadLocalRandomDouble() >= txn_read_proportion_) {
+      std::vector<DB::Field> values;
+      if (write_all_fields()) {
+        BuildValues(values);
+      } else {
+        BuildSingleValue(values);
+      }
+      status = db.Update(table_name_, key, values);
+    }
+    if (status != DB::kOK) {
+      db.AbortTransaction();
+      return false;
+    }
+  }
+  return db.CommitTransaction() == DB::kOK;
+}
+
+const bool registered = WorkloadFactory::RegisterWorkload(
+  "com.yahoo.ycsb.workloads.TransactionalWorkload",
+  []() { return dynamic_cast<CoreWorkload *>(new TransactionalWorkload); }
+);
+
+} // ycsbc
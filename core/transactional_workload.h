@@ -0,0 +1,56 @@
+//
+//  transactional_workload.h
+//  YCSB-cpp
+//
+
+#ifndef YCSB_C_TRANSACTIONAL_WORKLOAD_H_
+#define YCSB_C_TRANSACTIONAL_WORKLOAD_H_
+
+#include <string>
+
+#include "core_workload.h"
+
+namespace ycsbc {
+
+///
+/// Runs every transaction-phase operation as one multi-key database
+/// transaction: txn.keys keys drawn from the request distribution, each
+/// either read or read-modify-written. An operation that fails inside the
+/// transaction (lock timeout, deadlock, conflict) rolls it back. COMMIT,
+/// COMMIT-FAILED and ABORT are measured like the other operations; the load
+/// phase inserts as CoreWorkload does.
+///
+class TransactionalWorkload : public CoreWorkload {
+ public:
+  ///
+  /// The name of the property for the number of keys per transaction.
+  ///
+  static const std::string TXN_KEYS_PROPERTY;
+  static const std::string TXN_KEYS_DEFAULT;
+
+  ///
+  /// The name of the property for the share of the keys of a transaction
+  /// that are only read; the others are read-modify-written.
+  ///
+  static const std::string TXN_READ_PROPORTION_PROPERTY;
+  static const std::string TXN_READ_PROPORTION_DEFAULT;
+
+  TransactionalWorkload() : txn_keys_(0), txn_read_proportion_(0) {}
+  ~TransactionalWorkload() override {}
+
+  void Init(const utils::Properties &p) override;
+  bool DoTransaction(DB &db, ThreadState *state) override;
+  void DoTransactionAsync(DB &db, ThreadState *state, DoneCallback done) override {
+    done(DoTransaction(db, state));
+  }
+
+ protected:
+  DB::Status TransactionKeyRead(DB &db, const std::string &key);
+
+  int txn_keys_;
+  double txn_read_proportion_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_TRANSACTIONAL_WORKLOAD_H_
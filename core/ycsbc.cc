@@ -35,7 +35,7 @@ bool StrStartWith(const char *str, const char *pre);
 void ParseCommandLine(int argc, const char *argv[], ycsbc::utils::Properties &props);
 void SaveRunSummary(YAML::Node &node, ycsbc::utils::Properties &props, std::time_t &now);
 
-void StatusThread(ycsbc::Measurements *measurements, ycsbc::utils::CountDownLatch *latch, ycsbc::utils::CountDownLatch *init_latch, int interval, int interval_us, const std::string &tracefilename) {
+void StatusThread(ycsbc::Measurements *measurements, ycsbc::DB *db, ycsbc::utils::CountDownLatch *latch, ycsbc::utils::CountDownLatch *init_latch, int interval, int interval_us, const std::string &tracefilename) {
   using namespace std::chrono;
   init_latch->Await(); // wait for all client threads to finish initializing before start printing status
   time_point<system_clock> start = system_clock::now();
@@ -52,7 +52,12 @@ void StatusThread(ycsbc::Measurements *measurements, ycsbc::utils::CountDownLatc
     *os << std::put_time(std::localtime(&now_c), "%F %T") << ' '
               << static_cast<long long>(elapsed_time.count()) << " sec: ";
 
-    *os << measurements->GetStatusMsg() << std::endl;
+    *os << measurements->GetStatusMsg();
+    const std::string db_msg = db->GetStatusMsg();
+    if (!db_msg.empty()) {
+      *os << ' ' << db_msg;
+    }
+    *os << std::endl;
 
     if (done) {
       break;
@@ -155,7 +160,7 @@ int main(const int argc, const char *argv[]) {
     std::future<void> status_future;
     if (show_status) {
       status_future = std::async(std::launch::async, StatusThread,
-                                 measurements, &latch, &init_latch, status_interval, status_interval_us, status_trace);
+                                 measurements, dbs[0], &latch, &init_latch, status_interval, status_interval_us, status_trace);
     }
     std::vector<std::future<int>> client_threads;
     std::vector<ycsbc::utils::RateLimiter *> rate_limiters;
@@ -206,6 +211,7 @@ int main(const int argc, const char *argv[]) {
     load_summary["workload"] = props.GetProperty(ycsbc::WorkloadFactory::WORKLOAD_NAME_PROPERTY,
                                                 ycsbc::WorkloadFactory::WORKLOAD_NAME_DEFAULT);
     measurements->Emit(load_summary);
+    dbs[0]->EmitStats(load_summary);
     SaveRunSummary(load_summary, props, now_c);
   }
 
@@ -228,7 +234,7 @@ int main(const int argc, const char *argv[]) {
     std::future<void> status_future;
     if (show_status) {
       status_future = std::async(std::launch::async, StatusThread,
-                                 measurements, &latch, &init_latch, status_interval, status_interval_us, status_trace);
+                                 measurements, dbs[0], &latch, &init_latch, status_interval, status_interval_us, status_trace);
     }
     std::vector<std::future<int>> client_threads;
     std::vector<ycsbc::utils::RateLimiter *> rate_limiters;
@@ -285,6 +291,7 @@ int main(const int argc, const char *argv[]) {
     run_summary["workload"] = props.GetProperty(ycsbc::WorkloadFactory::WORKLOAD_NAME_PROPERTY,
                                                 ycsbc::WorkloadFactory::WORKLOAD_NAME_DEFAULT);
     measurements->Emit(run_summary);
+    dbs[0]->EmitStats(run_summary);
     SaveRunSummary(run_summary, props, now_c);
   }
 
@@ -47,6 +47,21 @@ namespace {
 
   const std::string PROP_BLOCK_RESTART_INTERVAL = "leveldb.block_restart_interval";
   const std::string PROP_BLOCK_RESTART_INTERVAL_DEFAULT = "0";
+
+  // scans of a workload larger than the cache can skip filling it
+  const std::string PROP_SCAN_FILL_CACHE = "leveldb.scan_fill_cache";
+  const std::string PROP_SCAN_FILL_CACHE_DEFAULT = "true";
+
+  // sync the log on every write
+  const std::string PROP_SYNC = "leveldb.sync";
+  const std::string PROP_SYNC_DEFAULT = "false";
+
+  // rows per WriteBatch in the load phase, 1 writes each insert on its own
+  const std::string PROP_LOAD_BATCH_SIZE = "leveldb.load_batch_size";
+  const std::string PROP_LOAD_BATCH_SIZE_DEFAULT = "1";
+
+  static bool batch_loaded = false;
+  static bool reopen = false;
 } // anonymous
 
 namespace ycsbc {
@@ -88,6 +103,16 @@ void LeveldbDB::Init() {
                                             CoreWorkload::FIELD_COUNT_DEFAULT));
   field_prefix_ = props.GetProperty(CoreWorkload::FIELD_NAME_PREFIX,
                                     CoreWorkload::FIELD_NAME_PREFIX_DEFAULT);
+  scan_options_.fill_cache = props.GetProperty(PROP_SCAN_FILL_CACHE, PROP_SCAN_FILL_CACHE_DEFAULT) == "true";
+  write_options_.sync = props.GetProperty(PROP_SYNC, PROP_SYNC_DEFAULT) == "true";
+
+  // only the load phase is batched, its last Cleanup() writes what is left
+  load_batch_size_ = std::stoi(props.GetProperty(PROP_LOAD_BATCH_SIZE, PROP_LOAD_BATCH_SIZE_DEFAULT));
+  load_batch_rows_ = 0;
+  batch_load_ = ReInitBeforeTransaction() && props.GetProperty("doload", "false") == "true" && !batch_loaded;
+  if (batch_load_) {
+    method_insert_ = &LeveldbDB::InsertBatched;
+  }
 
   ref_cnt_++;
   if (db_) {
@@ -105,12 +130,14 @@ void LeveldbDB::Init() {
 
   leveldb::Status s;
 
-  if (props.GetProperty(PROP_DESTROY, PROP_DESTROY_DEFAULT) == "true") {
+  // a database reopened for the run phase keeps what the load wrote
+  if (!reopen && props.GetProperty(PROP_DESTROY, PROP_DESTROY_DEFAULT) == "true") {
     s = leveldb::DestroyDB(db_path, opt);
     if (!s.ok()) {
       throw utils::Exception(std::string("LevelDB DestroyDB: ") + s.ToString());
     }
   }
+  reopen = true;
   s = leveldb::DB::Open(opt, db_path, &db_);
   if (!s.ok()) {
     throw utils::Exception(std::string("LevelDB Open: ") + s.ToString());
@@ -119,10 +146,22 @@ void LeveldbDB::Init() {
 
 void LeveldbDB::Cleanup() {
   const std::lock_guard<std::mutex> lock(mu_);
+  if (batch_load_) {
+    WriteLoadBatch();
+  }
   if (--ref_cnt_) {
     return;
   }
+  if (batch_load_) {
+    batch_loaded = true;
+  }
   delete db_;
+  db_ = nullptr;
+}
+
+bool LeveldbDB::ReInitBeforeTransaction() {
+  // the load phase ends with Cleanup() so the last batches are written
+  return std::stoi(props_->GetProperty(PROP_LOAD_BATCH_SIZE, PROP_LOAD_BATCH_SIZE_DEFAULT)) > 1;
 }
 
 void LeveldbDB::GetOptions(const utils::Properties &props, leveldb::Options *opt) {
@@ -269,7 +308,7 @@ DB::Status LeveldbDB::ReadSingleEntry(const std::string &table, const std::strin
 DB::Status LeveldbDB::ScanSingleEntry(const std::string &table, const std::string &key, int len,
                                       const std::vector<std::string> *fields,
                                       std::vector<std::vector<Field>> &result) {
-  leveldb::Iterator *db_iter = db_->NewIterator(leveldb::ReadOptions());
+  leveldb::Iterator *db_iter = db_->NewIterator(scan_options_);
   db_iter->Seek(key);
   for (int i = 0; db_iter->Valid() && i < len; i++) {
     std::string data = db_iter->value().ToString();
@@ -308,11 +347,9 @@ DB::Status LeveldbDB::UpdateSingleEntry(const std::string &table, const std::str
     }
     assert(found);
   }
-  leveldb::WriteOptions wopt;
-
   data.clear();
   SerializeRow(current_values, &data);
-  s = db_->Put(wopt, key, data);
+  s = db_->Put(write_options_, key, data);
   if (!s.ok()) {
     throw utils::Exception(std::string("LevelDB Put: ") + s.ToString());
   }
@@ -323,9 +360,7 @@ DB::Status LeveldbDB::InsertSingleEntry(const std::string &table, const std::str
                                         std::vector<Field> &values) {
   std::string data;
   SerializeRow(values, &data);
-  leveldb::WriteOptions wopt;
-  wopt.sync = true;
-  leveldb::Status s = db_->Put(wopt, key, data);
+  leveldb::Status s = db_->Put(write_options_, key, data);
   if (!s.ok()) {
     throw utils::Exception(std::string("LevelDB Put: ") + s.ToString());
   }
@@ -333,8 +368,7 @@ DB::Status LeveldbDB::InsertSingleEntry(const std::string &table, const std::str
 }
 
 DB::Status LeveldbDB::DeleteSingleEntry(const std::string &table, const std::string &key) {
-  leveldb::WriteOptions wopt;
-  leveldb::Status s = db_->Delete(wopt, key);
+  leveldb::Status s = db_->Delete(write_options_, key);
   if (!s.ok()) {
     throw utils::Exception(std::string("LevelDB Delete: ") + s.ToString());
   }
@@ -347,6 +381,7 @@ DB::Status LeveldbDB::ReadCompKeyRM(const std::string &table, const std::string
   leveldb::Iterator *db_iter = db_->NewIterator(leveldb::ReadOptions());
   db_iter->Seek(key);
   if (!db_iter->Valid() || KeyFromCompKey(db_iter->key().ToString()) != key) {
+    delete db_iter;
     return kNotFound;
   }
   if (fields != nullptr) {
@@ -387,7 +422,7 @@ DB::Status LeveldbDB::ReadCompKeyRM(const std::string &table, const std::string
 DB::Status LeveldbDB::ScanCompKeyRM(const std::string &table, const std::string &key, int len,
                                     const std::vector<std::string> *fields,
                                     std::vector<std::vector<Field>> &result) {
-  leveldb::Iterator *db_iter = db_->NewIterator(leveldb::ReadOptions());
+  leveldb::Iterator *db_iter = db_->NewIterator(scan_options_);
   db_iter->Seek(key);
   assert(db_iter->Valid() && KeyFromCompKey(db_iter->key().ToString()) == key);
   for (int i = 0; i < len && db_iter->Valid(); i++) {
@@ -430,20 +465,86 @@ DB::Status LeveldbDB::ScanCompKeyRM(const std::string &table, const std::string
 DB::Status LeveldbDB::ReadCompKeyCM(const std::string &table, const std::string &key,
                                     const std::vector<std::string> *fields,
                                     std::vector<Field> &result) {
-  return kNotImplemented;
+  std::vector<std::string> read_fields;
+  if (fields != nullptr) {
+    read_fields = *fields;
+  } else {
+    for (int i = 0; i < fieldcount_; i++) {
+      read_fields.push_back(field_prefix_ + std::to_string(i));
+    }
+  }
+  // one Get per column, the snapshot keeps them from different writes apart
+  leveldb::ReadOptions ropt;
+  ropt.snapshot = db_->GetSnapshot();
+  std::string value;
+  for (const std::string &field : read_fields) {
+    leveldb::Status s = db_->Get(ropt, BuildCompKey(key, field), &value);
+    if (!s.ok()) {
+      db_->ReleaseSnapshot(ropt.snapshot);
+      if (s.IsNotFound()) {
+        return kNotFound;
+      }
+      throw utils::Exception(std::string("LevelDB Get: ") + s.ToString());
+    }
+    result.push_back({field, value});
+  }
+  db_->ReleaseSnapshot(ropt.snapshot);
+  return kOK;
 }
 
 DB::Status LeveldbDB::ScanCompKeyCM(const std::string &table, const std::string &key, int len,
                                     const std::vector<std::string> *fields,
                                     std::vector<std::vector<Field>> &result) {
-  return kNotImplemented;
+  std::vector<std::string> scan_fields;
+  if (fields != nullptr) {
+    scan_fields = *fields;
+  } else {
+    for (int i = 0; i < fieldcount_; i++) {
+      scan_fields.push_back(field_prefix_ + std::to_string(i));
+    }
+  }
+  // one column at a time; the first column decides which rows are returned,
+  // the snapshot keeps the columns consistent with each other
+  leveldb::ReadOptions ropt = scan_options_;
+  ropt.snapshot = db_->GetSnapshot();
+  std::vector<std::string> row_keys;
+  for (size_t f = 0; f < scan_fields.size(); f++) {
+    const std::string &field = scan_fields[f];
+    const std::string prefix = field + ":";
+    leveldb::Iterator *db_iter = db_->NewIterator(ropt);
+    db_iter->Seek(prefix + key);
+    for (int i = 0; db_iter->Valid() && db_iter->key().starts_with(prefix); db_iter->Next()) {
+      std::string row_key = FieldFromCompKey(db_iter->key().ToString());
+      if (f == 0) {
+        if (i == len) {
+          break;
+        }
+        row_keys.push_back(row_key);
+        result.push_back(std::vector<Field>());
+      } else {
+        // skip rows the first column does not have
+        while (static_cast<size_t>(i) < row_keys.size() && row_keys[i] < row_key) {
+          i++;
+        }
+        if (static_cast<size_t>(i) == row_keys.size()) {
+          break;
+        }
+        if (row_keys[i] != row_key) {
+          continue;
+        }
+      }
+      result[i].push_back({field, db_iter->value().ToString()});
+      i++;
+    }
+    delete db_iter;
+  }
+  db_->ReleaseSnapshot(ropt.snapshot);
+  return kOK;
 }
 
 DB::Status LeveldbDB::InsertCompKey(const std::string &table, const std::string &key,
                                     std::vector<Field> &values) {
-  leveldb::WriteOptions wopt;
   leveldb::WriteBatch batch;
-  wopt.sync = true;
 
   std::string comp_key;
   for (Field &field : values) {
@@ -451,7 +552,7 @@ DB::Status LeveldbDB::InsertCompKey(const std::string &table, const std::string
     batch.Put(comp_key, field.second);
   }
 
-  leveldb::Status s = db_->Write(wopt, &batch);
+  leveldb::Status s = db_->Write(write_options_, &batch);
   if (!s.ok()) {
     throw utils::Exception(std::string("LevelDB Write: ") + s.ToString());
   }
@@ -459,7 +560,6 @@ DB::Status LeveldbDB::InsertCompKey(const std::string &table, const std::string
 }
 
 DB::Status LeveldbDB::DeleteCompKey(const std::string &table, const std::string &key) {
-  leveldb::WriteOptions wopt;
   leveldb::WriteBatch batch;
 
   std::string comp_key;
@@ -468,13 +568,42 @@ DB::Status LeveldbDB::DeleteCompKey(const std::string &table, const std::string
     batch.Delete(comp_key);
   }
 
-  leveldb::Status s = db_->Write(wopt, &batch);
+  leveldb::Status s = db_->Write(write_options_, &batch);
   if (!s.ok()) {
     throw utils::Exception(std::string("LevelDB Write: ") + s.ToString());
   }
   return kOK;
 }
 
+DB::Status LeveldbDB::InsertBatched(const std::string &table, const std::string &key,
+                                    std::vector<Field> &values) {
+  if (format_ == kSingleEntry) {
+    std::string data;
+    SerializeRow(values, &data);
+    load_batch_.Put(key, data);
+  } else {
+    for (Field &field : values) {
+      load_batch_.Put(BuildCompKey(key, field.first), field.second);
+    }
+  }
+  if (++load_batch_rows_ >= load_batch_size_) {
+    WriteLoadBatch();
+  }
+  return kOK;
+}
+
+void LeveldbDB::WriteLoadBatch() {
+  if (load_batch_rows_ == 0) {
+    return;
+  }
+  leveldb::Status s = db_->Write(write_options_, &load_batch_);
+  if (!s.ok()) {
+    throw utils::Exception(std::string("LevelDB Write: ") + s.ToString());
+  }
+  load_batch_.Clear();
+  load_batch_rows_ = 0;
+}
+
 DB *NewLeveldbDB() {
   return new LeveldbDB;
 }
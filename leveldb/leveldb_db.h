@@ -20,6 +20,7 @@
 #include <leveldb/status.h>
 #include <leveldb/cache.h>
 #include <leveldb/filter_policy.h>
+#include <leveldb/write_batch.h>
 
 namespace ycsbc {
 
@@ -32,6 +33,8 @@ class LeveldbDB : public DB {
 
   void Cleanup();
 
+  bool ReInitBeforeTransaction() override;
+
   Status Read(const std::string &table, const std::string &key,
               const std::vector<std::string> *fields, std::vector<Field> &result) {
     return (this->*(method_read_))(table, key, fields, result);
@@ -96,6 +99,10 @@ class LeveldbDB : public DB {
                        std::vector<Field> &values);
   Status DeleteCompKey(const std::string &table, const std::string &key);
 
+  Status InsertBatched(const std::string &table, const std::string &key,
+                       std::vector<Field> &values);
+  void WriteLoadBatch();
+
   Status (LeveldbDB::*method_read_)(const std::string &, const std:: string &,
                                     const std::vector<std::string> *, std::vector<Field> &);
   Status (LeveldbDB::*method_scan_)(const std::string &, const std::string &, int,
@@ -109,6 +116,14 @@ class LeveldbDB : public DB {
 
   int fieldcount_;
   std::string field_prefix_;
+  leveldb::ReadOptions scan_options_;
+  leveldb::WriteOptions write_options_;
+
+  // load phase: inserts collected into one WriteBatch per load_batch_size rows
+  bool batch_load_;
+  int load_batch_size_;
+  int load_batch_rows_;
+  leveldb::WriteBatch load_batch_;
 
   static leveldb::DB *db_;
   static int ref_cnt_;
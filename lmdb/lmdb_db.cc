@@ -8,6 +8,13 @@
 
 #include <string.h>
 #include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <thread>
 #if defined(_MSC_VER)
 #include "direct.h"
 #define mkdir(x, y) _mkdir(x)
@@ -16,10 +23,12 @@
 #include "lmdb_db.h"
 #include "core/core_workload.h"
 #include "core/db_factory.h"
+#include "core/multi_table_workload.h"
 #include "utils/properties.h"
 #include "utils/utils.h"
 
 #include <lmdb.h>
+#include <yaml-cpp/yaml.h>
 
 namespace {
   const std::string PROP_DBPATH = "lmdb.dbpath";
@@ -42,6 +51,56 @@ namespace {
 
   const std::string PROP_MAPASYNC = "lmdb.mapasync";
   const std::string PROP_MAPASYNC_DEFAULT = "false";
+
+  // keep a read-only transaction and cursors per client thread
+  const std::string PROP_REUSE_READ_TXN = "lmdb.reuse_read_txn";
+  const std::string PROP_REUSE_READ_TXN_DEFAULT = "true";
+
+  // reader table slots, each client thread holds one; 0 keeps LMDB's default of 126
+  const std::string PROP_MAXREADERS = "lmdb.maxreaders";
+  const std::string PROP_MAXREADERS_DEFAULT = "0";
+
+  const std::string PROP_CHECKPOINT_DIR = "lmdb.checkpoint_dir";
+  const std::string PROP_CHECKPOINT_DIR_DEFAULT = "";
+
+  // auto: create after a load, restore before a run without load
+  const std::string PROP_CHECKPOINT = "lmdb.checkpoint";
+  const std::string PROP_CHECKPOINT_DEFAULT = "auto";
+
+  // writes of all client threads are committed by one thread, up to
+  // group_commit_batch per transaction, waiting at most group_commit_delay_us
+  // for a batch to fill
+  const std::string PROP_GROUP_COMMIT = "lmdb.group_commit";
+  const std::string PROP_GROUP_COMMIT_DEFAULT = "false";
+
+  const std::string PROP_GROUP_COMMIT_BATCH = "lmdb.group_commit_batch";
+  const std::string PROP_GROUP_COMMIT_BATCH_DEFAULT = "64";
+
+  const std::string PROP_GROUP_COMMIT_DELAY_US = "lmdb.group_commit_delay_us";
+  const std::string PROP_GROUP_COMMIT_DELAY_US_DEFAULT = "100";
+
+  // rewrite only the updated values when their length is unchanged
+  const std::string PROP_INPLACE_UPDATE = "lmdb.inplace_update";
+  const std::string PROP_INPLACE_UPDATE_DEFAULT = "true";
+
+  static bool inplace_update = true;
+
+  static bool group_commit = false;
+  static size_t group_commit_batch = 0;
+  static int group_commit_delay_us = 0;
+  static std::thread group_thread;
+  static std::mutex group_mu;
+  static std::condition_variable group_cv;
+  static std::condition_variable group_done_cv;
+  static bool group_stop = false;
+
+  // commits and the writes in them, per phase
+  static std::atomic<uint64_t> group_commits{0};
+  static std::atomic<uint64_t> group_writes{0};
+
+  static std::string checkpoint_dir;
+  static bool checkpoint_create = false;
+  static bool reopen = false;
 } // anonymous
 
 namespace ycsbc {
@@ -51,13 +110,30 @@ std::string LmdbDB::field_prefix_;
 
 MDB_env *LmdbDB::env_;
 MDB_dbi LmdbDB::dbi_;
+std::unordered_map<std::string, MDB_dbi> LmdbDB::dbis_;
 int LmdbDB::ref_cnt_ = 0;
 std::mutex LmdbDB::mutex_;
 
+///
+/// A write waiting for the group committer. It lives on the stack of the
+/// client thread, which waits until done is set.
+///
+struct LmdbDB::PendingWrite {
+  WriteOp op;
+  MDB_dbi dbi;
+  const std::string *key;
+  const std::vector<Field> *values;
+  Status status;
+  std::string error;
+  bool done;
+};
+std::deque<LmdbDB::PendingWrite *> LmdbDB::group_queue_;
+
 void LmdbDB::Init() {
   const std::lock_guard<std::mutex> lock(mutex_);
 
   const utils::Properties &props = *props_;
+  reuse_read_txn_ = props.GetProperty(PROP_REUSE_READ_TXN, PROP_REUSE_READ_TXN_DEFAULT) == "true";
 
   if (ref_cnt_++) {
     return;
@@ -67,9 +143,12 @@ void LmdbDB::Init() {
                                             CoreWorkload::FIELD_COUNT_DEFAULT));
   field_prefix_ = props.GetProperty(CoreWorkload::FIELD_NAME_PREFIX,
                                     CoreWorkload::FIELD_NAME_PREFIX_DEFAULT);
+  inplace_update = props.GetProperty(PROP_INPLACE_UPDATE, PROP_INPLACE_UPDATE_DEFAULT) == "true";
 
   int ret;
-  int env_opt = 0;
+  // read transactions belong to the LmdbDB instance rather than the thread,
+  // a thread may hold a reset one while it writes
+  int env_opt = MDB_NOTLS;
   if (props.GetProperty(PROP_NOSYNC, PROP_NOSYNC_DEFAULT) == "true") {
     env_opt |= MDB_NOSYNC;
   }
@@ -96,6 +175,21 @@ void LmdbDB::Init() {
       throw utils::Exception(std::string("Init mdb_env_set_mapsize: ") + mdb_strerror(ret));
     }
   }
+  const unsigned int max_readers = std::stoul(props.GetProperty(PROP_MAXREADERS, PROP_MAXREADERS_DEFAULT));
+  if (max_readers > 0) {
+    ret = mdb_env_set_maxreaders(env_, max_readers);
+    if (ret) {
+      throw utils::Exception(std::string("Init mdb_env_set_maxreaders: ") + mdb_strerror(ret));
+    }
+  }
+  // one named database per workload table
+  const std::vector<std::string> tables = MultiTableWorkload::TableNames(props);
+  if (!tables.empty()) {
+    ret = mdb_env_set_maxdbs(env_, tables.size());
+    if (ret) {
+      throw utils::Exception(std::string("Init mdb_env_set_maxdbs: ") + mdb_strerror(ret));
+    }
+  }
   const std::string &db_path = props.GetProperty(PROP_DBPATH, PROP_DBPATH_DEFAULT);
   if (db_path == "") {
     throw utils::Exception("LMDB db path is missing");
@@ -104,6 +198,23 @@ void LmdbDB::Init() {
   if (ret && errno != EEXIST) {
     throw utils::Exception(std::string("Init mkdir: ") + strerror(errno));
   }
+
+  const bool do_load = props.GetProperty("doload", "false") == "true";
+  const std::string checkpoint = props.GetProperty(PROP_CHECKPOINT, PROP_CHECKPOINT_DEFAULT);
+  checkpoint_dir = props.GetProperty(PROP_CHECKPOINT_DIR, PROP_CHECKPOINT_DIR_DEFAULT);
+  checkpoint_create = !reopen && !checkpoint_dir.empty() &&
+                      (checkpoint == "create" || (checkpoint == "auto" && do_load));
+  if (!reopen && !checkpoint_dir.empty() && (checkpoint == "restore" || (checkpoint == "auto" && !do_load))) {
+    // the data file is updated in place, so it is copied rather than linked
+    std::error_code ec;
+    std::filesystem::remove(db_path + "/lock.mdb", ec);
+    std::filesystem::copy_file(checkpoint_dir + "/data.mdb", db_path + "/data.mdb",
+                               std::filesystem::copy_options::overwrite_existing, ec);
+    if (ec) {
+      throw utils::Exception("Init restore " + checkpoint_dir + ": " + ec.message());
+    }
+  }
+  reopen = true;
   ret = mdb_env_open(env_, db_path.c_str(), env_opt, 0664);
   if (ret) {
     throw utils::Exception(std::string("Init mdb_env_open: ") + mdb_strerror(ret));
@@ -118,29 +229,193 @@ void LmdbDB::Init() {
   if (ret) {
     throw utils::Exception(std::string("Init mdb_open: ") + mdb_strerror(ret));
   }
+  for (const std::string &table : tables) {
+    MDB_dbi dbi;
+    ret = mdb_dbi_open(txn, table.c_str(), MDB_CREATE, &dbi);
+    if (ret) {
+      throw utils::Exception(std::string("Init mdb_dbi_open ") + table + ": " + mdb_strerror(ret));
+    }
+    dbis_[table] = dbi;
+  }
   ret = mdb_txn_commit(txn);
   if (ret) {
     throw utils::Exception(std::string("Init mdb_txn_commit: ") + mdb_strerror(ret));
   }
+
+  group_commit = props.GetProperty(PROP_GROUP_COMMIT, PROP_GROUP_COMMIT_DEFAULT) == "true";
+  if (group_commit) {
+    group_commit_batch = std::stoul(props.GetProperty(PROP_GROUP_COMMIT_BATCH, PROP_GROUP_COMMIT_BATCH_DEFAULT));
+    group_commit_delay_us = std::stoi(props.GetProperty(PROP_GROUP_COMMIT_DELAY_US,
+                                                        PROP_GROUP_COMMIT_DELAY_US_DEFAULT));
+    if (group_commit_batch == 0) {
+      throw utils::Exception(PROP_GROUP_COMMIT_BATCH + " must be at least 1");
+    }
+    group_stop = false;
+    group_thread = std::thread(GroupCommit);
+  }
 }
 
 void LmdbDB::Cleanup() {
+  for (const auto &cursor : cursors_) {
+    mdb_cursor_close(cursor.second);
+  }
+  cursors_.clear();
+  if (read_txn_) {
+    mdb_txn_abort(read_txn_);
+    read_txn_ = nullptr;
+  }
   const std::lock_guard<std::mutex> lock(mutex_);
   if (--ref_cnt_) {
     return;
   }
+  if (group_commit) {
+    {
+      const std::lock_guard<std::mutex> group_lock(group_mu);
+      group_stop = true;
+    }
+    group_cv.notify_one();
+    group_thread.join();
+    group_commit = false;
+  }
+  if (checkpoint_create) {
+    std::error_code ec;
+    std::filesystem::remove_all(checkpoint_dir, ec);
+    std::filesystem::create_directories(checkpoint_dir, ec);
+    if (ec) {
+      throw utils::Exception("Cleanup checkpoint " + checkpoint_dir + ": " + ec.message());
+    }
+    int ret = mdb_env_copy2(env_, checkpoint_dir.c_str(), MDB_CP_COMPACT);
+    if (ret) {
+      throw utils::Exception(std::string("Cleanup mdb_env_copy2: ") + mdb_strerror(ret));
+    }
+    checkpoint_create = false;
+  }
+  for (const auto &table : dbis_) {
+    mdb_close(env_, table.second);
+  }
+  dbis_.clear();
   mdb_close(env_, dbi_);
   mdb_env_close(env_);
 }
 
-void LmdbDB::SerializeRow(const std::vector<Field> &values, std::string *data) {
+bool LmdbDB::ReInitBeforeTransaction() {
+  // the checkpoint is taken by the last Cleanup() of the load phase
+  const std::string checkpoint = props_->GetProperty(PROP_CHECKPOINT, PROP_CHECKPOINT_DEFAULT);
+  return props_->GetProperty(PROP_CHECKPOINT_DIR, PROP_CHECKPOINT_DIR_DEFAULT) != "" &&
+         (checkpoint == "auto" || checkpoint == "create");
+}
+
+MDB_txn *LmdbDB::BeginRead() {
+  if (read_txn_) {
+    int ret = mdb_txn_renew(read_txn_);
+    if (ret) {
+      throw utils::Exception(std::string("BeginRead mdb_txn_renew: ") + mdb_strerror(ret));
+    }
+    return read_txn_;
+  }
+  int ret = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &read_txn_);
+  if (ret) {
+    throw utils::Exception(std::string("BeginRead mdb_txn_begin: ") + mdb_strerror(ret));
+  }
+  return read_txn_;
+}
+
+void LmdbDB::EndRead() {
+  // a reset transaction keeps its reader slot but releases the snapshot,
+  // so it does not hold back page reuse by writers
+  if (reuse_read_txn_) {
+    mdb_txn_reset(read_txn_);
+  } else {
+    mdb_txn_abort(read_txn_);
+    read_txn_ = nullptr;
+  }
+}
+
+MDB_cursor *LmdbDB::ReadCursor(MDB_txn *txn, MDB_dbi dbi) {
+  MDB_cursor *&cursor = cursors_[dbi];
+  if (cursor) {
+    int ret = mdb_cursor_renew(txn, cursor);
+    if (ret) {
+      throw utils::Exception(std::string("ReadCursor mdb_cursor_renew: ") + mdb_strerror(ret));
+    }
+    return cursor;
+  }
+  int ret = mdb_cursor_open(txn, dbi, &cursor);
+  if (ret) {
+    throw utils::Exception(std::string("ReadCursor mdb_cursor_open: ") + mdb_strerror(ret));
+  }
+  return cursor;
+}
+
+void LmdbDB::EndCursor(MDB_dbi dbi) {
+  // cursors of read-only transactions outlive them until closed
+  if (!reuse_read_txn_) {
+    mdb_cursor_close(cursors_[dbi]);
+    cursors_.erase(dbi);
+  }
+}
+
+void LmdbDB::EmitStats(YAML::Node &node) {
+  const uint64_t commits = group_commits.exchange(0);
+  const uint64_t writes = group_writes.exchange(0);
+  if (commits == 0) {
+    return;
+  }
+  YAML::Node lmdb_node;
+  lmdb_node["group_commits"] = commits;
+  lmdb_node["avg_group_size"] = static_cast<double>(writes) / commits;
+  node["lmdb"] = lmdb_node;
+}
+
+bool LmdbDB::LocateFields(const char *row, size_t row_len, const std::vector<Field> &values,
+                          std::vector<std::pair<size_t, const std::string *>> *patches) {
+  const char *lim = row + row_len;
+  for (const Field &field : values) {
+    const char *p = row;
+    bool found = false;
+    while (p < lim) {
+      uint32_t name_len, value_len;
+      memcpy(&name_len, p, sizeof(uint32_t));
+      const char *name = p + sizeof(uint32_t);
+      memcpy(&value_len, name + name_len, sizeof(uint32_t));
+      const char *value = name + name_len + sizeof(uint32_t);
+      if (name_len == field.first.size() && memcmp(name, field.first.data(), name_len) == 0) {
+        if (value_len != field.second.size()) {
+          return false;
+        }
+        patches->emplace_back(value - row, &field.second);
+        found = true;
+        break;
+      }
+      p = value + value_len;
+    }
+    if (!found) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t LmdbDB::RowSize(const std::vector<Field> &values) {
+  size_t size = 0;
+  for (const Field &field : values) {
+    size += 2 * sizeof(uint32_t) + field.first.size() + field.second.size();
+  }
+  return size;
+}
+
+void LmdbDB::SerializeRow(const std::vector<Field> &values, char *data) {
   for (const Field &field : values) {
     uint32_t len = field.first.size();
-    data->append(reinterpret_cast<char *>(&len), sizeof(uint32_t));
-    data->append(field.first.data(), field.first.size());
+    memcpy(data, &len, sizeof(uint32_t));
+    data += sizeof(uint32_t);
+    memcpy(data, field.first.data(), field.first.size());
+    data += field.first.size();
     len = field.second.size();
-    data->append(reinterpret_cast<char *>(&len), sizeof(uint32_t));
-    data->append(field.second.data(), field.second.size());
+    memcpy(data, &len, sizeof(uint32_t));
+    data += sizeof(uint32_t);
+    memcpy(data, field.second.data(), field.second.size());
+    data += field.second.size();
   }
 }
 
@@ -188,18 +463,13 @@ void LmdbDB::DeserializeRow(std::vector<Field> *values, const char *data_ptr, si
 DB::Status LmdbDB::Read(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
                         std::vector<Field> &result) {
   DB::Status s = kOK;
-  MDB_txn *txn;
   MDB_val key_slice, val_slice;
 
   key_slice.mv_data = static_cast<void *>(const_cast<char *>(key.data()));
   key_slice.mv_size = key.size();
 
-  int ret;
-  ret = mdb_txn_begin(env_, nullptr, MDB_RDONLY, &txn);
-  if (ret) {
-    throw utils::Exception(std::string("Read mdb_txn_begin: ") + mdb_strerror(ret));
-  }
-  ret = mdb_get(txn, dbi_, &key_slice, &val_slice);
+  MDB_txn *txn = BeginRead();
+  int ret = mdb_get(txn, Dbi(table), &key_slice, &val_slice);
   if (ret == MDB_NOTFOUND) {
     s = kNotFound;
     goto cleanup;
@@ -212,30 +482,23 @@ DB::Status LmdbDB::Read(const std::string &table, const std::string &key, const
     DeserializeRow(&result, static_cast<char *>(val_slice.mv_data), val_slice.mv_size);
   }
 cleanup:
-  mdb_txn_abort(txn);
+  EndRead();
   return s;
 }
 
 DB::Status LmdbDB::Scan(const std::string &table, const std::string &key, int len,
                         const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result) {
   DB::Status s = kOK;
-  MDB_txn *txn;
-  MDB_cursor *cursor;
   MDB_val key_slice, val_slice;
 
   key_slice.mv_data = static_cast<void *>(const_cast<char *>(key.data()));
   key_slice.mv_size = key.size();
 
-  int ret;
-  ret = mdb_txn_begin(env_, nullptr, 0, &txn);
-  if (ret) {
-    throw utils::Exception(std::string("Scan mdb_txn_begin: ") + mdb_strerror(ret));
-  }
-  ret = mdb_cursor_open(txn, dbi_, &cursor);
-  if (ret) {
-    throw utils::Exception(std::string("Scan mdb_cursor_open: ") + mdb_strerror(ret));
-  }
-  ret = mdb_cursor_get(cursor, &key_slice, &val_slice, MDB_SET);
+  const MDB_dbi dbi = Dbi(table);
+  MDB_txn *txn = BeginRead();
+  MDB_cursor *cursor = ReadCursor(txn, dbi);
+  // the first key at or after the start key
+  int ret = mdb_cursor_get(cursor, &key_slice, &val_slice, MDB_SET_RANGE);
   if (ret == MDB_NOTFOUND) {
     s = kNotFound;
     goto cleanup;
@@ -253,106 +516,186 @@ DB::Status LmdbDB::Scan(const std::string &table, const std::string &key, int le
     ret = mdb_cursor_get(cursor, &key_slice, &val_slice, MDB_NEXT);
   }
 cleanup:
-  mdb_cursor_close(cursor);
-  mdb_txn_abort(txn);
+  EndCursor(dbi);
+  EndRead();
   return s;
 }
 
 DB::Status LmdbDB::Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
-  MDB_txn *txn;
-  MDB_val key_slice, val_slice;
+  return Write(kUpdate, table, key, &values);
+}
 
-  key_slice.mv_data = static_cast<void *>(const_cast<char *>(key.data()));
-  key_slice.mv_size = key.size();
+DB::Status LmdbDB::Insert(const std::string &table, const std::string &key, std::vector<Field> &values) {
+  return Write(kInsert, table, key, &values);
+}
 
-  int ret;
-  ret = mdb_txn_begin(env_, nullptr, 0, &txn);
-  if (ret) {
-    throw utils::Exception(std::string("Update mdb_txn_begin: ") + mdb_strerror(ret));
+DB::Status LmdbDB::Delete(const std::string &table, const std::string &key) {
+  return Write(kDelete, table, key, nullptr);
+}
+
+DB::Status LmdbDB::Write(WriteOp op, const std::string &table, const std::string &key,
+                         const std::vector<Field> *values) {
+  if (group_commit) {
+    PendingWrite write{op, Dbi(table), &key, values, kOK, "", false};
+    return SubmitWrite(write);
   }
-  ret = mdb_get(txn, dbi_, &key_slice, &val_slice);
+  MDB_txn *txn;
+  int ret = mdb_txn_begin(env_, nullptr, 0, &txn);
   if (ret) {
-    throw utils::Exception(std::string("Update mdb_get: ") + mdb_strerror(ret));
-  }
-  std::vector<Field> current_values;
-  DeserializeRow(&current_values, static_cast<char *>(val_slice.mv_data), val_slice.mv_size);
-  for (Field &new_field : values) {
-    bool found MAYBE_UNUSED = false;
-    for (Field &cur_field : current_values) {
-      if (cur_field.first == new_field.first) {
-        found = true;
-        cur_field.second = new_field.second;
-        break;
-      }
-    }
-    assert(found);
+    throw utils::Exception(std::string("Write mdb_txn_begin: ") + mdb_strerror(ret));
   }
-
-  std::string data;
-  SerializeRow(current_values, &data);
-  val_slice.mv_data = const_cast<char *>(data.data());
-  val_slice.mv_size = data.size();
-  ret = mdb_put(txn, dbi_, &key_slice, &val_slice, 0);
-  if (ret) {
-    throw utils::Exception(std::string("Update mdb_put: ") + mdb_strerror(ret));
+  Status s = ApplyWrite(txn, op, Dbi(table), key, values);
+  if (s != kOK) {
+    mdb_txn_abort(txn);
+    return s;
   }
-
   ret = mdb_txn_commit(txn);
   if (ret) {
-    throw utils::Exception(std::string("Update mdb_txn_commit: ") + mdb_strerror(ret));
+    throw utils::Exception(std::string("Write mdb_txn_commit: ") + mdb_strerror(ret));
   }
   return kOK;
 }
 
-DB::Status LmdbDB::Insert(const std::string &table, const std::string &key, std::vector<Field> &values) {
-  MDB_txn *txn;
+DB::Status LmdbDB::ApplyWrite(MDB_txn *txn, WriteOp op, MDB_dbi dbi, const std::string &key,
+                              const std::vector<Field> *values) {
   MDB_val key_slice, val_slice;
-
   key_slice.mv_data = static_cast<void *>(const_cast<char *>(key.data()));
   key_slice.mv_size = key.size();
 
-  std::string data;
-  SerializeRow(values, &data);
-  val_slice.mv_data = static_cast<void *>(const_cast<char *>(data.data()));
-  val_slice.mv_size = data.size();
-
   int ret;
-  ret = mdb_txn_begin(env_, nullptr, 0, &txn);
-  if (ret) {
-    throw utils::Exception(std::string("Insert mdb_txn_begin: ") + mdb_strerror(ret));
+  if (op == kDelete) {
+    ret = mdb_del(txn, dbi, &key_slice, nullptr);
+    if (ret == MDB_NOTFOUND) {
+      return kNotFound;
+    } else if (ret) {
+      throw utils::Exception(std::string("Delete mdb_del: ") + mdb_strerror(ret));
+    }
+    return kOK;
   }
-  ret = mdb_put(txn, dbi_, &key_slice, &val_slice, 0);
-  if (ret) {
-    throw utils::Exception(std::string("Insert mdb_put: ") + mdb_strerror(ret));
+
+  std::vector<Field> current_values;
+  if (op == kUpdate) {
+    ret = mdb_get(txn, dbi, &key_slice, &val_slice);
+    if (ret == MDB_NOTFOUND) {
+      return kNotFound;
+    } else if (ret) {
+      throw utils::Exception(std::string("Update mdb_get: ") + mdb_strerror(ret));
+    }
+    const char *old_row = static_cast<const char *>(val_slice.mv_data);
+    const size_t row_len = val_slice.mv_size;
+    std::vector<std::pair<size_t, const std::string *>> patches;
+    if (inplace_update && LocateFields(old_row, row_len, *values, &patches)) {
+      val_slice.mv_data = nullptr;
+      ret = mdb_put(txn, dbi, &key_slice, &val_slice, MDB_RESERVE);
+      if (ret) {
+        throw utils::Exception(std::string("Update mdb_put: ") + mdb_strerror(ret));
+      }
+      // a same-size put keeps a row on a page already dirty in this
+      // transaction where it is; otherwise the page is copied on write and
+      // the old row stays intact until the commit
+      char *row = static_cast<char *>(val_slice.mv_data);
+      if (row != old_row) {
+        memcpy(row, old_row, row_len);
+      }
+      for (const auto &patch : patches) {
+        memcpy(row + patch.first, patch.second->data(), patch.second->size());
+      }
+      return kOK;
+    }
+    DeserializeRow(&current_values, static_cast<char *>(val_slice.mv_data), val_slice.mv_size);
+    for (const Field &new_field : *values) {
+      bool found MAYBE_UNUSED = false;
+      for (Field &cur_field : current_values) {
+        if (cur_field.first == new_field.first) {
+          found = true;
+          cur_field.second = new_field.second;
+          break;
+        }
+      }
+      assert(found);
+    }
+    values = &current_values;
   }
-  ret = mdb_txn_commit(txn);
+
+  // serialize straight into the space mdb_put reserves in the map
+  val_slice.mv_data = nullptr;
+  val_slice.mv_size = RowSize(*values);
+  ret = mdb_put(txn, dbi, &key_slice, &val_slice, MDB_RESERVE);
   if (ret) {
-    throw utils::Exception(std::string("Insert mdb_txn_commit: ") + mdb_strerror(ret));
+    throw utils::Exception(std::string(op == kUpdate ? "Update" : "Insert") + " mdb_put: " + mdb_strerror(ret));
   }
+  SerializeRow(*values, static_cast<char *>(val_slice.mv_data));
   return kOK;
 }
 
-DB::Status LmdbDB::Delete(const std::string &table, const std::string &key) {
-  MDB_txn *txn;
-  MDB_val key_slice;
-
-  key_slice.mv_data = static_cast<void *>(const_cast<char *>(key.data()));
-  key_slice.mv_size = key.size();
-
-  int ret;
-  ret = mdb_txn_begin(env_, nullptr, 0, &txn);
-  if (ret) {
-    throw utils::Exception(std::string("Delete mdb_txn_begin: ") + mdb_strerror(ret));
+DB::Status LmdbDB::SubmitWrite(PendingWrite &write) {
+  std::unique_lock<std::mutex> lock(group_mu);
+  group_queue_.push_back(&write);
+  if (group_queue_.size() == 1 || group_queue_.size() >= group_commit_batch) {
+    group_cv.notify_one();
   }
-  ret = mdb_del(txn, dbi_, &key_slice, nullptr);
-  if (ret) {
-    throw utils::Exception(std::string("Delete mdb_del: ") + mdb_strerror(ret));
+  // the latency of the write includes the commit of its batch
+  group_done_cv.wait(lock, [&write] { return write.done; });
+  if (!write.error.empty()) {
+    throw utils::Exception(write.error);
   }
-  ret = mdb_txn_commit(txn);
-  if (ret) {
-    throw utils::Exception(std::string("Delete mdb_txn_commit: ") + mdb_strerror(ret));
+  return write.status;
+}
+
+void LmdbDB::GroupCommit() {
+  std::vector<PendingWrite *> batch;
+  std::unique_lock<std::mutex> lock(group_mu);
+  while (true) {
+    group_cv.wait(lock, [] { return group_stop || !group_queue_.empty(); });
+    if (group_queue_.empty()) {
+      break;
+    }
+    // give the other client threads a moment to join the batch
+    group_cv.wait_for(lock, std::chrono::microseconds(group_commit_delay_us),
+                      [] { return group_stop || group_queue_.size() >= group_commit_batch; });
+    const size_t n = std::min(group_queue_.size(), group_commit_batch);
+    batch.assign(group_queue_.begin(), group_queue_.begin() + n);
+    group_queue_.erase(group_queue_.begin(), group_queue_.begin() + n);
+    lock.unlock();
+
+    CommitBatch(batch);
+
+    lock.lock();
+    for (PendingWrite *write : batch) {
+      write->done = true;
+    }
+    group_done_cv.notify_all();
   }
-  return kOK;
+}
+
+void LmdbDB::CommitBatch(const std::vector<PendingWrite *> &batch) {
+  MDB_txn *txn = nullptr;
+  try {
+    int ret = mdb_txn_begin(env_, nullptr, 0, &txn);
+    if (ret) {
+      txn = nullptr;
+      throw utils::Exception(std::string("GroupCommit mdb_txn_begin: ") + mdb_strerror(ret));
+    }
+    for (PendingWrite *write : batch) {
+      write->status = ApplyWrite(txn, write->op, write->dbi, *write->key, write->values);
+    }
+    ret = mdb_txn_commit(txn);
+    txn = nullptr;
+    if (ret) {
+      throw utils::Exception(std::string("GroupCommit mdb_txn_commit: ") + mdb_strerror(ret));
+    }
+  } catch (const utils::Exception &e) {
+    // the whole batch fails, each client thread rethrows
+    if (txn) {
+      mdb_txn_abort(txn);
+    }
+    for (PendingWrite *write : batch) {
+      write->error = e.what();
+    }
+    return;
+  }
+  group_commits.fetch_add(1, std::memory_order_relaxed);
+  group_writes.fetch_add(batch.size(), std::memory_order_relaxed);
 }
 
 DB *NewLmdbDB() {
@@ -8,8 +8,11 @@
 #ifndef YCSB_C_LMDB_DB_H_
 #define YCSB_C_LMDB_DB_H_
 
+#include <deque>
 #include <string>
 #include <mutex>
+#include <unordered_map>
+#include <utility>
 
 #include "core/db.h"
 
@@ -19,13 +22,15 @@ namespace ycsbc {
 
 class LmdbDB : public DB {
  public:
-  LmdbDB() {}
+  LmdbDB() : reuse_read_txn_(true), read_txn_(nullptr) {}
   ~LmdbDB() {}
 
   void Init();
 
   void Cleanup();
 
+  bool ReInitBeforeTransaction() override;
+
   Status Read(const std::string &table, const std::string &key,
               const std::vector<std::string> *fields, std::vector<Field> &result);
 
@@ -38,19 +43,54 @@ class LmdbDB : public DB {
 
   Status Delete(const std::string &table, const std::string &key);
 
+  void EmitStats(YAML::Node &node) override;
+
  private:
-  void SerializeRow(const std::vector<Field> &values, std::string *data);
-  void DeserializeRowFilter(std::vector<Field> *values, const char *data_ptr, size_t data_len,
-                            const std::vector<std::string> &fields);
-  void DeserializeRow(std::vector<Field> *values, const char *data_ptr, size_t data_len);
+  enum WriteOp {
+    kInsert,
+    kUpdate,
+    kDelete
+  };
+  struct PendingWrite;
+  static MDB_dbi Dbi(const std::string &table) {
+    auto it = dbis_.find(table);
+    return it == dbis_.end() ? dbi_ : it->second;
+  }
+  MDB_txn *BeginRead();
+  void EndRead();
+  MDB_cursor *ReadCursor(MDB_txn *txn, MDB_dbi dbi);
+  void EndCursor(MDB_dbi dbi);
+
+  Status Write(WriteOp op, const std::string &table, const std::string &key, const std::vector<Field> *values);
+  static Status ApplyWrite(MDB_txn *txn, WriteOp op, MDB_dbi dbi, const std::string &key,
+                           const std::vector<Field> *values);
+  static Status SubmitWrite(PendingWrite &write);
+  static void GroupCommit();
+  static void CommitBatch(const std::vector<PendingWrite *> &batch);
+
+  static bool LocateFields(const char *row, size_t row_len, const std::vector<Field> &values,
+                           std::vector<std::pair<size_t, const std::string *>> *patches);
+  static size_t RowSize(const std::vector<Field> &values);
+  static void SerializeRow(const std::vector<Field> &values, char *data);
+  static void DeserializeRowFilter(std::vector<Field> *values, const char *data_ptr, size_t data_len,
+                                   const std::vector<std::string> &fields);
+  static void DeserializeRow(std::vector<Field> *values, const char *data_ptr, size_t data_len);
+
+  // read-only transaction kept across reads with mdb_txn_reset/mdb_txn_renew,
+  // and its cursors renewed with it
+  bool reuse_read_txn_;
+  MDB_txn *read_txn_;
+  std::unordered_map<MDB_dbi, MDB_cursor *> cursors_;
 
   static size_t field_count_;
   static std::string field_prefix_;
 
   static MDB_env *env_;
   static MDB_dbi dbi_;
+  static std::unordered_map<std::string, MDB_dbi> dbis_;
   static int ref_cnt_;
   static std::mutex mutex_;
+  static std::deque<PendingWrite *> group_queue_;
 };
 
 DB *NewLmdbDB();
@@ -1,11 +1,16 @@
 #include "postgres_db.h"
 
+#include <arpa/inet.h>
+
+#include <cassert>
 #include <cstdlib>
 #include <iostream>
 #include <string>
 #include <string.h>
 
+#include "core/core_workload.h"
 #include "core/db_factory.h"
+#include "utils/utils.h"
 
 using namespace std;
 
@@ -19,9 +24,20 @@ const string PROP_POSTGRES_PORT_DEFAULT = "5432";
 const string PROP_POSTGRES_DBNAME = "pgsql.dbname";
 const string PROP_POSTGRES_DBNAME_DEFAULT = "postgres";
 
+// keep the operations of async.queuedepth in flight on the connection (libpq 14)
+const string PROP_POSTGRES_PIPELINE = "pgsql.pipeline";
+const string PROP_POSTGRES_PIPELINE_DEFAULT = "false";
+
 const string PRIMARY_KEY = "YCSB_KEY";
 const string COLUMN_NAME = "YCSB_VALUE";
 
+// pg_type OIDs; text is sent and received as its raw bytes in binary format
+const Oid TEXT_OID = 25;
+const Oid INT4_OID = 23;
+const int BINARY_FORMATS[2] = {1, 1};
+
+const char *const OP_NAMES[] = {"READ", "SCAN", "UPDATE", "INSERT", "DELETE"};
+
 };  // namespace
 
 namespace ycsbc {
@@ -63,6 +79,23 @@ void PostgresDB::Init() {
   }
   PQclear(res);
 
+  prepareStatements(table_name);
+
+  pipeline_ = props.GetProperty(PROP_POSTGRES_PIPELINE, PROP_POSTGRES_PIPELINE_DEFAULT) == "true";
+  if (pipeline_) {
+#ifdef LIBPQ_HAS_PIPELINING
+    // nonblocking, so sending never stalls on a server busy writing results back
+    if (PQsetnonblocking(conn_, 1) != 0 || !PQenterPipelineMode(conn_)) {
+      cerr << "Failed to enter pipeline mode, error: " << PQerrorMessage(conn_) << endl;
+      PQfinish(conn_);
+      exit(1);
+    }
+#else
+    PQfinish(conn_);
+    throw utils::Exception(PROP_POSTGRES_PIPELINE + " needs libpq 14 or later");
+#endif
+  }
+
   // query = "SET synchronous_commit=OFF";
   // res = PQexec(conn_, query.c_str());
   // if (PQresultStatus(res) != PGRES_COMMAND_OK) {
@@ -73,55 +106,125 @@ void PostgresDB::Init() {
   cout << "Connected." << endl;
 }
 
-DB::Status PostgresDB::Read(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
-                            std::vector<Field> &result) {
-  const string query("SELECT " + COLUMN_NAME + " FROM " + table + " WHERE " + PRIMARY_KEY + " = '" + key + "'");
-  PGresult *res = PQexec(conn_, query.c_str());
+void PostgresDB::Cleanup() {
+#ifdef LIBPQ_HAS_PIPELINING
+  while (!pending_.empty()) {
+    Poll();
+  }
+#endif
+  PQfinish(conn_);
+}
+
+void PostgresDB::prepareStatements(const std::string &table) {
+  const string queries[kNumOps] = {
+      "SELECT " + COLUMN_NAME + " FROM " + table + " WHERE " + PRIMARY_KEY + " = $1",
+      "SELECT " + COLUMN_NAME + " FROM " + table + " WHERE " + PRIMARY_KEY + " >= $1 ORDER BY " + PRIMARY_KEY +
+          " LIMIT $2",
+      "UPDATE " + table + " SET " + COLUMN_NAME + " = $1 WHERE " + PRIMARY_KEY + " = $2",
+      "INSERT INTO " + table + " (" + PRIMARY_KEY + "," + COLUMN_NAME + ") VALUES ($1, $2)",
+      "DELETE FROM " + table + " WHERE " + PRIMARY_KEY + " = $1",
+  };
+  const string names[kNumOps] = {"read", "scan", "update", "insert", "delete"};
+  const int n_params[kNumOps] = {1, 2, 2, 2, 1};
+  const Oid types[kNumOps][2] = {
+      {TEXT_OID}, {TEXT_OID, INT4_OID}, {TEXT_OID, TEXT_OID}, {TEXT_OID, TEXT_OID}, {TEXT_OID}};
+
+  std::array<string, kNumOps> &statements = statements_[table];
+  for (int op = 0; op < kNumOps; op++) {
+    statements[op] = "ycsb_" + names[op] + "_" + table;
+    PGresult *res = PQprepare(conn_, statements[op].c_str(), queries[op].c_str(), n_params[op], types[op]);
+    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+      cerr << "Failed to prepare " << queries[op] << ", status: " << PQresStatus(PQresultStatus(res))
+           << ", error: " << PQresultErrorMessage(res) << endl;
+      PQclear(res);
+      PQfinish(conn_);
+      exit(1);
+    }
+    PQclear(res);
+  }
+}
+
+DB::Status PostgresDB::execute(Request &req, const std::string &table, int n_params, const char *const *values,
+                               const int *lengths) {
+#ifdef LIBPQ_HAS_PIPELINING
+  if (pipeline_) {
+    Status s = Status::kError;
+    bool done = false;
+    req.cb = [&s, &done](Status status) {
+      s = status;
+      done = true;
+    };
+    send(req, table, n_params, values, lengths);
+    while (!done) {
+      Poll();
+    }
+    return s;
+  }
+#endif
+  auto it = statements_.find(table);
+  if (it == statements_.end()) {
+    cerr << "[" << OP_NAMES[req.op] << "] No statements prepared for table " << table << endl;
+    return Status::kError;
+  }
+  PGresult *res = PQexecPrepared(conn_, it->second[req.op].c_str(), n_params, values, lengths, BINARY_FORMATS, 1);
+  return finish(req, res);
+}
+
+DB::Status PostgresDB::finish(const Request &req, PGresult *res) {
   ExecStatusType status = PQresultStatus(res);
-  Status ret;
+  ExecStatusType expected = (req.op == kRead || req.op == kScan) ? PGRES_TUPLES_OK : PGRES_COMMAND_OK;
+  Status ret = Status::kOK;
 
-  if (status == PGRES_TUPLES_OK) {
+  if (status != expected) {
+    cerr << "[" << OP_NAMES[req.op] << "] Status: " << PQresStatus(status) << ", error: " << PQresultErrorMessage(res)
+         << endl;
+    ret = Status::kError;
+  } else if (req.op == kRead) {
     if (PQntuples(res) == 1) {
       assert(PQnfields(res) == 1);
-      ret = Status::kOK;
-      result.push_back(Field("", PQgetvalue(res, 0, 0)));
+      req.result->push_back(Field("", string(PQgetvalue(res, 0, 0), PQgetlength(res, 0, 0))));
     } else {
       ret = Status::kNotFound;
     }
-  } else {
-    cerr << "[READ] Status: " << PQresStatus(status) << ", error: " << PQresultErrorMessage(res) << endl;
-    ret = Status::kError;
+  } else if (req.op == kScan) {
+    const int rows = PQntuples(res);
+    req.scan_result->reserve(rows);
+    for (int i = 0; i < rows; i++) {
+      req.scan_result->push_back({Field("", string(PQgetvalue(res, i, 0), PQgetlength(res, i, 0)))});
+    }
+  } else if (req.op == kUpdate && stoi(PQcmdTuples(res)) == 0) {
+    ret = Status::kNotFound;
   }
   PQclear(res);
   return ret;
 }
 
+DB::Status PostgresDB::Read(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
+                            std::vector<Field> &result) {
+  const char *values[1] = {key.data()};
+  const int lengths[1] = {static_cast<int>(key.size())};
+  Request req{kRead, &result};
+  return execute(req, table, 1, values, lengths);
+}
+
+DB::Status PostgresDB::Scan(const std::string &table, const std::string &key, int len,
+                            const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result) {
+  const uint32_t limit = htonl(len);
+  const char *values[2] = {key.data(), reinterpret_cast<const char *>(&limit)};
+  const int lengths[2] = {static_cast<int>(key.size()), sizeof(limit)};
+  Request req{kScan, nullptr, &result};
+  return execute(req, table, 2, values, lengths);
+}
+
 DB::Status PostgresDB::Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
   string value;
   for (auto &f : values) {
     value.append(f.second);
   }
-  const char *param[1] = {value.data()};
-  const int param_len[1] = {static_cast<int>(value.size())};
-  const int param_format[1] = {0};
-  const string query("UPDATE " + table + " SET " + COLUMN_NAME + " = $1::text WHERE " + PRIMARY_KEY + " = '" + key + "'");
-  
-  PGresult *res = PQexecParams(conn_, query.c_str(), 1, NULL, param, param_len, param_format, 0);
-  ExecStatusType status = PQresultStatus(res);
-  Status ret;
-
-  if (status == PGRES_COMMAND_OK) {
-    if (stoi(PQcmdTuples(res)) == 0) {
-      ret = Status::kNotFound;
-    } else {
-      ret = Status::kOK;
-    }
-  } else {
-    cerr << "[UPDATE] Status: " << PQresStatus(status) << ", error: " << PQresultErrorMessage(res) << endl;
-    ret = Status::kError;
-  }
-  PQclear(res);
-  return ret;
+  const char *params[2] = {value.data(), key.data()};
+  const int lengths[2] = {static_cast<int>(value.size()), static_cast<int>(key.size())};
+  Request req{kUpdate};
+  return execute(req, table, 2, params, lengths);
 }
 
 DB::Status PostgresDB::Insert(const std::string &table, const std::string &key, std::vector<Field> &values) {
@@ -129,40 +232,145 @@ DB::Status PostgresDB::Insert(const std::string &table, const std::string &key,
   for (auto &f : values) {
     value.append(f.second);
   }
-  const char *param[1] = {value.data()};
-  const int param_len[1] = {static_cast<int>(value.size())};
-  const int param_format[1] = {0};
-  const string query("INSERT INTO " + table + " (" + PRIMARY_KEY + "," + COLUMN_NAME + ") VALUES ('" + key + "', $1::varchar(255))");
+  const char *params[2] = {key.data(), value.data()};
+  const int lengths[2] = {static_cast<int>(key.size()), static_cast<int>(value.size())};
+  Request req{kInsert};
+  return execute(req, table, 2, params, lengths);
+}
 
-  PGresult *res = PQexecParams(conn_, query.c_str(), 1, NULL, param, param_len, param_format, 0);
-  ExecStatusType status = PQresultStatus(res);
-  Status ret;
+DB::Status PostgresDB::Delete(const std::string &table, const std::string &key) {
+  const char *values[1] = {key.data()};
+  const int lengths[1] = {static_cast<int>(key.size())};
+  Request req{kDelete};
+  return execute(req, table, 1, values, lengths);
+}
 
-  if (status == PGRES_COMMAND_OK) {
-    ret = Status::kOK;
-  } else {
-    cerr << "[INSERT] Status: " << PQresStatus(status) << ", error: " << PQresultErrorMessage(res) << endl;
-    ret = Status::kError;
+#ifdef LIBPQ_HAS_PIPELINING
+void PostgresDB::send(Request &req, const std::string &table, int n_params, const char *const *values,
+                      const int *lengths) {
+  auto it = statements_.find(table);
+  if (it == statements_.end()) {
+    cerr << "[" << OP_NAMES[req.op] << "] No statements prepared for table " << table << endl;
+    req.cb(Status::kError);
+    return;
+  }
+  // libpq copies the parameters into its output buffer, they need not outlive the call
+  if (!PQsendQueryPrepared(conn_, it->second[req.op].c_str(), n_params, values, lengths, BINARY_FORMATS, 1)) {
+    cerr << "[" << OP_NAMES[req.op] << "] Failed to send, error: " << PQerrorMessage(conn_) << endl;
+    req.cb(Status::kError);
+    return;
+  }
+  pending_.push_back(std::move(req));
+  // a sync per statement keeps it its own transaction, an error aborts only that one
+  if (!PQpipelineSync(conn_)) {
+    cerr << "[" << OP_NAMES[pending_.back().op] << "] Failed to sync, error: " << PQerrorMessage(conn_) << endl;
   }
-  PQclear(res);
-  return ret;
 }
 
-DB::Status PostgresDB::Delete(const std::string &table, const std::string &key) {
-  const string query("DELETE FROM " + table + " WHERE " + PRIMARY_KEY + " = '" + key + "'");
-  PGresult *res = PQexec(conn_, query.c_str());
-  ExecStatusType status = PQresultStatus(res);
-  Status ret;
+int PostgresDB::Poll() {
+  if (!pipeline_) {
+    return 0;
+  }
+  int completed = 0;
+  // push out what the nonblocking PQsend* calls left buffered, then read what arrived
+  if (PQflush(conn_) < 0 || !PQconsumeInput(conn_)) {
+    cerr << "[PIPELINE] error: " << PQerrorMessage(conn_) << endl;
+    while (!pending_.empty()) {
+      Request req = std::move(pending_.front());
+      pending_.pop_front();
+      completed++;
+      req.cb(Status::kError);
+    }
+    return completed;
+  }
+  while (!pending_.empty() && !PQisBusy(conn_)) {
+    PGresult *res = PQgetResult(conn_);
+    // NULL ends the results of one statement
+    if (res == nullptr) {
+      continue;
+    }
+    if (PQresultStatus(res) == PGRES_PIPELINE_SYNC) {
+      PQclear(res);
+      continue;
+    }
+    Request req = std::move(pending_.front());
+    pending_.pop_front();
+    Status s = finish(req, res);
+    completed++;
+    req.cb(s);
+  }
+  return completed;
+}
 
-  if (status == PGRES_COMMAND_OK) {
-    ret = Status::kOK;
-  } else {
-    cerr << "[DELETE] Status: " << PQresStatus(status) << ", error: " << PQresultErrorMessage(res) << endl;
-    ret = Status::kError;
+void PostgresDB::ReadAsync(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
+                           std::vector<Field> &result, Callback cb) {
+  if (!pipeline_) {
+    cb(Read(table, key, fields, result));
+    return;
   }
-  PQclear(res);
-  return ret;
+  const char *values[1] = {key.data()};
+  const int lengths[1] = {static_cast<int>(key.size())};
+  Request req{kRead, &result, nullptr, std::move(cb)};
+  send(req, table, 1, values, lengths);
+}
+
+void PostgresDB::ScanAsync(const std::string &table, const std::string &key, int len,
+                           const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result,
+                           Callback cb) {
+  if (!pipeline_) {
+    cb(Scan(table, key, len, fields, result));
+    return;
+  }
+  const uint32_t limit = htonl(len);
+  const char *values[2] = {key.data(), reinterpret_cast<const char *>(&limit)};
+  const int lengths[2] = {static_cast<int>(key.size()), sizeof(limit)};
+  Request req{kScan, nullptr, &result, std::move(cb)};
+  send(req, table, 2, values, lengths);
+}
+
+void PostgresDB::UpdateAsync(const std::string &table, const std::string &key, std::vector<Field> &values,
+                             Callback cb) {
+  if (!pipeline_) {
+    cb(Update(table, key, values));
+    return;
+  }
+  string value;
+  for (auto &f : values) {
+    value.append(f.second);
+  }
+  const char *params[2] = {value.data(), key.data()};
+  const int lengths[2] = {static_cast<int>(value.size()), static_cast<int>(key.size())};
+  Request req{kUpdate, nullptr, nullptr, std::move(cb)};
+  send(req, table, 2, params, lengths);
+}
+
+void PostgresDB::InsertAsync(const std::string &table, const std::string &key, std::vector<Field> &values,
+                             Callback cb) {
+  if (!pipeline_) {
+    cb(Insert(table, key, values));
+    return;
+  }
+  string value;
+  for (auto &f : values) {
+    value.append(f.second);
+  }
+  const char *params[2] = {key.data(), value.data()};
+  const int lengths[2] = {static_cast<int>(key.size()), static_cast<int>(value.size())};
+  Request req{kInsert, nullptr, nullptr, std::move(cb)};
+  send(req, table, 2, params, lengths);
+}
+
+void PostgresDB::DeleteAsync(const std::string &table, const std::string &key, Callback cb) {
+  if (!pipeline_) {
+    cb(Delete(table, key));
+    return;
+  }
+  const char *values[1] = {key.data()};
+  const int lengths[1] = {static_cast<int>(key.size())};
+  Request req{kDelete, nullptr, nullptr, std::move(cb)};
+  send(req, table, 1, values, lengths);
 }
+#endif
 
 const bool registered = DBFactory::RegisterDB("postgres", []() { return dynamic_cast<DB *>(new PostgresDB); });
 
@@ -7,23 +7,26 @@
 
 #include <libpq-fe.h>
 
+#include <array>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
 #include "core/db.h"
-#include "core/properties.h"
+#include "utils/properties.h"
 
 namespace ycsbc {
 
 class PostgresDB : public DB {
  public:
   void Init() override;
-  void Cleanup() override { PQfinish(conn_); }
+  void Cleanup() override;
 
   Status Read(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
               std::vector<Field> &result) override;
 
   Status Scan(const std::string &table, const std::string &key, int len, const std::vector<std::string> *fields,
-              std::vector<std::vector<Field>> &result) override {
-    return Status::kNotImplemented;
-  }
+              std::vector<std::vector<Field>> &result) override;
 
   Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) override;
 
@@ -31,11 +34,54 @@ class PostgresDB : public DB {
 
   Status Delete(const std::string &table, const std::string &key) override;
 
+#ifdef LIBPQ_HAS_PIPELINING
+  void ReadAsync(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
+                 std::vector<Field> &result, Callback cb) override;
+  void ScanAsync(const std::string &table, const std::string &key, int len, const std::vector<std::string> *fields,
+                 std::vector<std::vector<Field>> &result, Callback cb) override;
+  void UpdateAsync(const std::string &table, const std::string &key, std::vector<Field> &values,
+                   Callback cb) override;
+  void InsertAsync(const std::string &table, const std::string &key, std::vector<Field> &values,
+                   Callback cb) override;
+  void DeleteAsync(const std::string &table, const std::string &key, Callback cb) override;
+  int Poll() override;
+#endif
+
  protected:
-  std::string createReadStatement();
-  std::string createUpdateStatement();
-  std::string createInsertStatement();
-  std::string createDeleteStatement();
+  enum Op { kRead, kScan, kUpdate, kInsert, kDelete, kNumOps };
+
+  /**
+   * one statement execution, and where its result goes
+   */
+  struct Request {
+    Op op;
+    std::vector<Field> *result = nullptr;
+    std::vector<std::vector<Field>> *scan_result = nullptr;
+    Callback cb;
+  };
+
+  /**
+   * prepares the statements of every operation on table as
+   * ycsb_<op>_<table>, parameters and results in binary format
+   */
+  void prepareStatements(const std::string &table);
+
+  /**
+   * runs a prepared statement and waits for its result
+   */
+  Status execute(Request &req, const std::string &table, int n_params, const char *const *values,
+                 const int *lengths);
+  /**
+   * turns the result of req into a status, and clears it
+   */
+  Status finish(const Request &req, PGresult *res);
+
+#ifdef LIBPQ_HAS_PIPELINING
+  /**
+   * queues a prepared statement in the pipeline, req.cb runs from Poll()
+   */
+  void send(Request &req, const std::string &table, int n_params, const char *const *values, const int *lengths);
+#endif
 
  protected:
   /**
@@ -45,7 +91,11 @@ class PostgresDB : public DB {
    * need to run concurrent commands, use multiple connections.)
    */
   PGconn *conn_;
-  char escape_buf_[2048];
+  std::unordered_map<std::string, std::array<std::string, kNumOps>> statements_;
+
+  // statements sent in pipeline mode whose results have not arrived yet, in order
+  bool pipeline_ = false;
+  std::deque<Request> pending_;
 };
 
 }  // namespace ycsbc
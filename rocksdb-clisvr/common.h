@@ -22,6 +22,10 @@ const std::string PROP_MSG_SIZE_DEFAULT = "1024";
 const std::string PROP_PHY_PORT = "rocksdb-clisvr.phy_port";
 const std::string PROP_PHY_PORT_DEFAULT = "0";
 
+// outstanding requests per client thread, shared with the client loop
+const std::string PROP_QUEUE_DEPTH = "async.queuedepth";
+const std::string PROP_QUEUE_DEPTH_DEFAULT = "1";
+
 const std::string PROP_NAME = "rocksdb.dbname";
 const std::string PROP_NAME_DEFAULT = "";
 
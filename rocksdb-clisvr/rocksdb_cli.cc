@@ -7,6 +7,7 @@
 
 #include "common.h"
 #include "core/db_factory.h"
+#include "utils/utils.h"
 
 #define DEBUG 0
 
@@ -18,7 +19,14 @@ erpc::Nexus *RocksdbCli::nexus_ = nullptr;
 
 void cli_sm_handler(int, erpc::SmEventType, erpc::SmErrType, void *) {}
 
-void rpc_cont_func(void *context, void *_tag) { reinterpret_cast<RocksdbCli *>(context)->notifyRpcComplete(); }
+void rpc_cont_func(void *context, void *tag) {
+  RocksdbCli *cli = reinterpret_cast<RocksdbCli *>(context);
+  if (tag == nullptr) {
+    cli->notifyRpcComplete();
+  } else {
+    cli->CompleteSlot(reinterpret_cast<RocksdbCli::AsyncSlot *>(tag));
+  }
+}
 
 void RocksdbCli::Init() {
   std::lock_guard<std::mutex> guard(lk_);
@@ -52,9 +60,28 @@ void RocksdbCli::Init() {
   const int msg_size = std::stoull(props.GetProperty(PROP_MSG_SIZE, PROP_MSG_SIZE_DEFAULT));
   req_ = rpc_->alloc_msg_buffer_or_die(msg_size);
   resp_ = rpc_->alloc_msg_buffer_or_die(msg_size);
+
+  const int queue_depth = std::stoi(props.GetProperty(PROP_QUEUE_DEPTH, PROP_QUEUE_DEPTH_DEFAULT));
+  if (queue_depth > 1) {
+    slots_.resize(queue_depth);
+    for (AsyncSlot &slot : slots_) {
+      slot.req = rpc_->alloc_msg_buffer_or_die(msg_size);
+      slot.resp = rpc_->alloc_msg_buffer_or_die(msg_size);
+      free_slots_.push_back(&slot);
+    }
+  }
 }
 
 void RocksdbCli::Cleanup() {
+  while (free_slots_.size() != slots_.size()) {
+    rpc_->run_event_loop_once();
+  }
+  for (AsyncSlot &slot : slots_) {
+    rpc_->free_msg_buffer(slot.req);
+    rpc_->free_msg_buffer(slot.resp);
+  }
+  slots_.clear();
+  free_slots_.clear();
   rpc_->free_msg_buffer(req_);
   rpc_->free_msg_buffer(resp_);
   delete rpc_;
@@ -135,6 +162,91 @@ DB::Status RocksdbCli::Delete(const std::string &table, const std::string &key)
   return *reinterpret_cast<DB::Status *>(resp_.buf_);
 }
 
+RocksdbCli::AsyncSlot *RocksdbCli::AcquireSlot() {
+  if (slots_.empty()) {
+    throw utils::Exception("async requests need " + PROP_QUEUE_DEPTH + " > 1");
+  }
+  while (free_slots_.empty()) {
+    rpc_->run_event_loop_once();
+  }
+  AsyncSlot *slot = free_slots_.back();
+  free_slots_.pop_back();
+  return slot;
+}
+
+void RocksdbCli::CompleteSlot(AsyncSlot *slot) {
+  DB::Status s;
+  if (slot->resp.get_data_size() < sizeof(DB::Status)) {
+    s = DB::kError;
+  } else {
+    s = *reinterpret_cast<DB::Status *>(slot->resp.buf_);
+  }
+  if (s == DB::kOK && (slot->req_type == READ_REQ || slot->req_type == SCAN_REQ)) {
+    size_t v_size = slot->resp.get_data_size() - sizeof(DB::Status);
+    const char *v_base = reinterpret_cast<const char *>(slot->resp.buf_ + sizeof(DB::Status));
+    if (slot->req_type == READ_REQ) {
+      DeserializeRow(*slot->result, v_base, v_base + v_size);
+    } else {
+      DeserializeRowVector(*slot->scan_result, v_base, v_base + v_size);
+    }
+  }
+  // release the slot first so the callback can submit the next request
+  Callback cb = std::move(slot->cb);
+  free_slots_.push_back(slot);
+  completed_++;
+  cb(s);
+}
+
+void RocksdbCli::ReadAsync(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
+                           std::vector<Field> &result, Callback cb) {
+  AsyncSlot *slot = AcquireSlot();
+  slot->req_type = READ_REQ;
+  slot->cb = std::move(cb);
+  slot->result = &result;
+  size_t k_size = SerializeKey(key, reinterpret_cast<char *>(slot->req.buf_));
+  rpc_->resize_msg_buffer(&slot->req, k_size);
+  rpc_->enqueue_request(session_num_, READ_REQ, &slot->req, &slot->resp, rpc_cont_func, slot);
+}
+
+void RocksdbCli::ScanAsync(const std::string &table, const std::string &key, int len,
+                           const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result,
+                           Callback cb) {
+  AsyncSlot *slot = AcquireSlot();
+  slot->req_type = SCAN_REQ;
+  slot->cb = std::move(cb);
+  slot->scan_result = &result;
+  size_t k_size = SerializeKey(key, reinterpret_cast<char *>(slot->req.buf_));
+  *reinterpret_cast<int *>(slot->req.buf_ + k_size) = len;
+  rpc_->resize_msg_buffer(&slot->req, k_size + sizeof(int));
+  rpc_->enqueue_request(session_num_, SCAN_REQ, &slot->req, &slot->resp, rpc_cont_func, slot);
+}
+
+void RocksdbCli::UpdateAsync(const std::string &table, const std::string &key, std::vector<Field> &values,
+                             Callback cb) {
+  AsyncSlot *slot = AcquireSlot();
+  slot->req_type = PUT_REQ;
+  slot->cb = std::move(cb);
+  size_t k_size = SerializeKey(key, reinterpret_cast<char *>(slot->req.buf_));
+  size_t v_size = SerializeRow(values, reinterpret_cast<char *>(slot->req.buf_ + k_size));
+  rpc_->resize_msg_buffer(&slot->req, k_size + v_size);
+  rpc_->enqueue_request(session_num_, PUT_REQ, &slot->req, &slot->resp, rpc_cont_func, slot);
+}
+
+void RocksdbCli::DeleteAsync(const std::string &table, const std::string &key, Callback cb) {
+  AsyncSlot *slot = AcquireSlot();
+  slot->req_type = DELETE_REQ;
+  slot->cb = std::move(cb);
+  size_t k_size = SerializeKey(key, reinterpret_cast<char *>(slot->req.buf_));
+  rpc_->resize_msg_buffer(&slot->req, k_size);
+  rpc_->enqueue_request(session_num_, DELETE_REQ, &slot->req, &slot->resp, rpc_cont_func, slot);
+}
+
+int RocksdbCli::Poll() {
+  completed_ = 0;
+  rpc_->run_event_loop_once();
+  return completed_;
+}
+
 void RocksdbCli::pollForRpcComplete() {
   while (!complete_)
     rpc_->run_event_loop_once();
@@ -11,7 +11,7 @@ class RocksdbCli : public DB {
   friend void rpc_cont_func(void *context, void *tag);
 
  public:
-  RocksdbCli() : complete_(false) {}
+  RocksdbCli() : complete_(false), completed_(0) {}
   ~RocksdbCli() override;
   void Init() override;
   void Cleanup() override;
@@ -26,12 +26,40 @@ class RocksdbCli : public DB {
   }
   Status Delete(const std::string &table, const std::string &key) override;
 
+  void ReadAsync(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
+                 std::vector<Field> &result, Callback cb) override;
+  void ScanAsync(const std::string &table, const std::string &key, int record_count,
+                 const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result,
+                 Callback cb) override;
+  void UpdateAsync(const std::string &table, const std::string &key, std::vector<Field> &values,
+                   Callback cb) override;
+  void InsertAsync(const std::string &table, const std::string &key, std::vector<Field> &values,
+                   Callback cb) override {
+    UpdateAsync(table, key, values, std::move(cb));
+  }
+  void DeleteAsync(const std::string &table, const std::string &key, Callback cb) override;
+  int Poll() override;
+
   bool ReInitBeforeTransaction() override { return true; }
 
  protected:
   void pollForRpcComplete();
   void notifyRpcComplete();
 
+  /**
+   * one outstanding async request, passed to eRPC as the continuation tag
+   */
+  struct AsyncSlot {
+    erpc::MsgBuffer req;
+    erpc::MsgBuffer resp;
+    uint8_t req_type;
+    Callback cb;
+    std::vector<Field> *result;
+    std::vector<std::vector<Field>> *scan_result;
+  };
+  AsyncSlot *AcquireSlot();
+  void CompleteSlot(AsyncSlot *slot);
+
  public:
   /**
    * key format:
@@ -63,6 +91,10 @@ class RocksdbCli : public DB {
   static std::atomic<uint8_t> global_rpc_id_;
 
   bool complete_;
+
+  std::vector<AsyncSlot> slots_;
+  std::vector<AsyncSlot *> free_slots_;
+  int completed_;
 };
 
 }  // namespace ycsbc
@@ -11,6 +11,7 @@
 #include "common.h"
 #include "core/command_line.h"
 #include "core/db.h"
+#include "rocksdb/rocksdb_checkpoint.h"
 #include "utils/properties.h"
 #include "utils/utils.h"
 #include "rpc.h"
@@ -27,6 +28,7 @@ static std::shared_ptr<rocksdb::Cache> block_cache;
 static std::shared_ptr<rocksdb::Cache> block_cache_compressed;
 rocksdb::DB *ServerContext::db_ = nullptr;
 bool ServerContext::sync = false;
+static bool checkpoint_create = false;
 
 void server_func(erpc::Nexus *nexus, int thread_id, const utils::Properties *props);
 void GetOptions(const utils::Properties &props, rocksdb::Options *opt,
@@ -66,6 +68,11 @@ int main(const int argc, const char *argv[]) {
     t.join();
   }
 
+  if (checkpoint_create) {
+    CreateRocksdbCheckpoint(ServerContext::db_,
+                            props.GetProperty(PROP_CHECKPOINT_DIR, PROP_CHECKPOINT_DIR_DEFAULT));
+    std::cout << "RocksDB checkpoint created" << std::endl;
+  }
   delete ServerContext::db_;
 
   return 0;
@@ -160,12 +167,18 @@ void scan_handler(erpc::ReqHandle *req_handle, void *context) {
   std::string key = DeserializeKey(reinterpret_cast<const char *>(req->buf_));
   int len = *reinterpret_cast<int *>(req->buf_ + sizeof(uint32_t) + key.size());
 
-  rocksdb::Iterator *db_iter = db->NewIterator(rocksdb::ReadOptions());
-  db_iter->Seek(key);
-  
+  auto &scanner = static_cast<ServerContext *>(context)->scanner_;
+  const size_t resp_size = static_cast<ServerContext *>(context)->resp_size_;
+  rocksdb::Iterator *db_iter = scanner.Seek(db, db->DefaultColumnFamily(), key, len);
+
+  // values are copied straight from the iterator; rows that no longer fit
+  // in the response buffer are left out
   size_t offset = sizeof(DB::Status);
   for (int i = 0; db_iter->Valid() && i < len; i++) {
-    std::string data = db_iter->value().ToString();
+    const rocksdb::Slice data = db_iter->value();
+    if (offset + sizeof(uint32_t) + data.size() > resp_size) {
+      break;
+    }
     *reinterpret_cast<uint32_t *>(resp.buf_ + offset) = data.size();
     offset += sizeof(uint32_t);
     memcpy(resp.buf_ + offset, data.data(), data.size());
@@ -173,7 +186,7 @@ void scan_handler(erpc::ReqHandle *req_handle, void *context) {
 
     db_iter->Next();
   }
-  delete db_iter;
+  scanner.Done();
   *reinterpret_cast<DB::Status *>(resp.buf_) = DB::kOK;
   rpc->resize_msg_buffer(&resp, offset);
   rpc->enqueue_response(req_handle, &resp);
@@ -199,8 +212,17 @@ void server_func(erpc::Nexus *nexus, int thread_id, const utils::Properties *pro
       std::vector<rocksdb::ColumnFamilyHandle *> cf_handles;
       GetOptions(*props, &opt, &cf_descs);
 
+      // a server started with rocksdb.destroy=true serves a load, any other serves a run
+      const bool destroy = props->GetProperty(PROP_DESTROY, PROP_DESTROY_DEFAULT) == "true";
+      const std::string checkpoint = props->GetProperty(PROP_CHECKPOINT, PROP_CHECKPOINT_DEFAULT);
+      const std::string checkpoint_dir = props->GetProperty(PROP_CHECKPOINT_DIR, PROP_CHECKPOINT_DIR_DEFAULT);
+      checkpoint_create = !checkpoint_dir.empty() && (checkpoint == "create" || (checkpoint == "auto" && destroy));
+
       rocksdb::Status s;
-      if (props->GetProperty(PROP_DESTROY, PROP_DESTROY_DEFAULT) == "true") {
+      if (!checkpoint_dir.empty() && (checkpoint == "restore" || (checkpoint == "auto" && !destroy))) {
+        RestoreRocksdbCheckpoint(checkpoint_dir, db_path);
+        std::cout << "RocksDB restored from " << checkpoint_dir << std::endl;
+      } else if (destroy) {
         s = rocksdb::DestroyDB(db_path, opt);
         if (!s.ok()) throw utils::Exception(std::string("RocksDB DestroyDB: ") + s.ToString());
       }
@@ -225,9 +247,12 @@ void server_func(erpc::Nexus *nexus, int thread_id, const utils::Properties *pro
 
   const int msg_size = std::stoull(props->GetProperty(PROP_MSG_SIZE, PROP_MSG_SIZE_DEFAULT));
   c.resp_buf_ = rpc.alloc_msg_buffer_or_die(msg_size);
+  c.resp_size_ = msg_size;
+  c.scanner_.Init(*props);
   while (run) {
     rpc.run_event_loop(1000);
   }
+  c.scanner_.Clear();
   rpc.free_msg_buffer(c.resp_buf_);
 
   std::cout << "thread " << thread_id << " stop running" << std::endl;
@@ -2,6 +2,7 @@
 #define YCSB_C_ROCKSDB_SVR_H_
 
 #include "common.h"
+#include "rocksdb/rocksdb_scan.h"
 #include "rpc.h"
 
 #include <rocksdb/db.h>
@@ -20,6 +21,8 @@ class ServerContext {
  public:
   erpc::Rpc<erpc::CTransport> *rpc_;
   erpc::MsgBuffer resp_buf_;
+  size_t resp_size_;
+  ycsbc::RocksdbScanner scanner_;
   static rocksdb::DB *db_;
   static bool sync;
   int session_num_;
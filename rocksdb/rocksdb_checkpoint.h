@@ -0,0 +1,87 @@
+//
+//  rocksdb_checkpoint.h
+//  YCSB-cpp
+//
+//  Checkpoint a loaded database once and restore it before every run, shared
+//  by the rocksdb binding and rocksdb_svr.
+//
+
+#ifndef YCSB_C_ROCKSDB_CHECKPOINT_H_
+#define YCSB_C_ROCKSDB_CHECKPOINT_H_
+
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+#include "utils/utils.h"
+
+#include <rocksdb/db.h>
+#include <rocksdb/utilities/checkpoint.h>
+
+namespace ycsbc {
+
+const std::string PROP_CHECKPOINT_DIR = "rocksdb.checkpoint_dir";
+const std::string PROP_CHECKPOINT_DIR_DEFAULT = "";
+
+// auto: create after a load, restore before a run without load
+const std::string PROP_CHECKPOINT = "rocksdb.checkpoint";
+const std::string PROP_CHECKPOINT_DEFAULT = "auto";
+
+///
+/// Replace dir with a checkpoint of db. SST files are hard links into the
+/// database directory, the memtable is flushed first so no WAL is needed.
+///
+inline void CreateRocksdbCheckpoint(rocksdb::DB *db, const std::string &dir) {
+  std::error_code ec;
+  std::filesystem::remove_all(dir, ec);
+  if (ec) {
+    throw utils::Exception("RocksDB checkpoint remove " + dir + ": " + ec.message());
+  }
+  rocksdb::Checkpoint *checkpoint;
+  rocksdb::Status s = rocksdb::Checkpoint::Create(db, &checkpoint);
+  if (!s.ok()) {
+    throw utils::Exception(std::string("RocksDB Checkpoint::Create: ") + s.ToString());
+  }
+  s = checkpoint->CreateCheckpoint(dir, 0);
+  delete checkpoint;
+  if (!s.ok()) {
+    throw utils::Exception(std::string("RocksDB CreateCheckpoint: ") + s.ToString());
+  }
+}
+
+///
+/// Rebuild db_path from the checkpoint in dir. Immutable SST files are hard
+/// linked; MANIFEST, CURRENT and OPTIONS are copied because the database
+/// appends to or rewrites them. Falls back to copying across filesystems.
+///
+inline void RestoreRocksdbCheckpoint(const std::string &dir, const std::string &db_path) {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  if (!fs::is_directory(dir, ec)) {
+    throw utils::Exception("RocksDB checkpoint " + dir + " does not exist");
+  }
+  fs::remove_all(db_path, ec);
+  if (!ec) {
+    fs::create_directories(db_path, ec);
+  }
+  if (ec) {
+    throw utils::Exception("RocksDB restore " + db_path + ": " + ec.message());
+  }
+  for (const fs::directory_entry &entry : fs::directory_iterator(dir, ec)) {
+    const fs::path target = fs::path(db_path) / entry.path().filename();
+    if (entry.path().extension() == ".sst") {
+      fs::create_hard_link(entry.path(), target, ec);
+      if (!ec) {
+        continue;
+      }
+    }
+    fs::copy_file(entry.path(), target, ec);
+    if (ec) {
+      throw utils::Exception("RocksDB restore " + target.string() + ": " + ec.message());
+    }
+  }
+}
+
+} // ycsbc
+
+#endif // YCSB_C_ROCKSDB_CHECKPOINT_H_
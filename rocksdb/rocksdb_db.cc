@@ -7,18 +7,38 @@
 //
 
 #include "rocksdb_db.h"
+#include "rocksdb_checkpoint.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <sstream>
+#include <thread>
 
 #include "core/core_workload.h"
 #include "core/db_factory.h"
+#include "core/multi_table_workload.h"
 #include "utils/utils.h"
 
 #include <rocksdb/cache.h>
 #include <rocksdb/filter_policy.h>
+#include <rocksdb/iostats_context.h>
 #include <rocksdb/merge_operator.h>
+#include <rocksdb/perf_context.h>
+#include <rocksdb/perf_level.h>
+#include <rocksdb/slice_transform.h>
+#include <rocksdb/sst_file_writer.h>
+#include <rocksdb/statistics.h>
 #include <rocksdb/status.h>
 #include <rocksdb/utilities/options_util.h>
 #include <rocksdb/write_batch.h>
 
+#include <yaml-cpp/yaml.h>
+
 namespace {
   const std::string PROP_NAME = "rocksdb.dbname";
   const std::string PROP_NAME_DEFAULT = "";
@@ -26,6 +46,11 @@ namespace {
   const std::string PROP_FORMAT = "rocksdb.format";
   const std::string PROP_FORMAT_DEFAULT = "single";
 
+  // row format: length of the "<key>:" prefix given to a capped prefix
+  // extractor, 0 cuts each key after the ":" that ends its row key
+  const std::string PROP_ROW_PREFIX_LENGTH = "rocksdb.row_prefix_length";
+  const std::string PROP_ROW_PREFIX_LENGTH_DEFAULT = "0";
+
   const std::string PROP_MERGEUPDATE = "rocksdb.mergeupdate";
   const std::string PROP_MERGEUPDATE_DEFAULT = "false";
 
@@ -104,6 +129,199 @@ namespace {
   const std::string PROP_FS_URI = "rocksdb.fs_uri";
   const std::string PROP_FS_URI_DEFAULT = "";
 
+  // load phase writes sorted SST files and ingests them instead of Put()
+  const std::string PROP_BULKLOAD = "rocksdb.bulkload";
+  const std::string PROP_BULKLOAD_DEFAULT = "false";
+
+  const std::string PROP_BULKLOAD_DIR = "rocksdb.bulkload_dir";
+  const std::string PROP_BULKLOAD_DIR_DEFAULT = "";
+
+  // bytes a client buffers before sorting them into one SST file
+  const std::string PROP_BULKLOAD_BUFFER_SIZE = "rocksdb.bulkload_buffer_size";
+  const std::string PROP_BULKLOAD_BUFFER_SIZE_DEFAULT = "268435456";
+
+  const std::string PROP_BULKLOAD_COMPACT = "rocksdb.bulkload_compact";
+  const std::string PROP_BULKLOAD_COMPACT_DEFAULT = "true";
+
+  // attach rocksdb::Statistics; its tickers and histograms go into the run
+  // summary and the status line
+  const std::string PROP_STATISTICS = "rocksdb.statistics";
+  const std::string PROP_STATISTICS_DEFAULT = "false";
+
+  // fraction of operations that record PerfContext and IOStatsContext
+  const std::string PROP_PERF_SAMPLE_RATE = "rocksdb.perf_sample_rate";
+  const std::string PROP_PERF_SAMPLE_RATE_DEFAULT = "0";
+
+  static std::shared_ptr<rocksdb::Statistics> statistics;
+
+  // tickers reported per status interval
+  const std::vector<std::pair<rocksdb::Tickers, std::string>> kStatusTickers = {
+    {rocksdb::STALL_MICROS, "StallMicros"},
+    {rocksdb::BLOCK_CACHE_HIT, "CacheHit"},
+    {rocksdb::BLOCK_CACHE_MISS, "CacheMiss"},
+    {rocksdb::BYTES_READ, "BytesRead"},
+    {rocksdb::BYTES_WRITTEN, "BytesWritten"},
+    {rocksdb::COMPACT_READ_BYTES, "CompactReadBytes"},
+    {rocksdb::COMPACT_WRITE_BYTES, "CompactWriteBytes"},
+  };
+
+  struct PerfField {
+    const char *name;
+    uint64_t rocksdb::PerfContext::*field;
+  };
+  const PerfField kPerfFields[] = {
+    {"block_read_count", &rocksdb::PerfContext::block_read_count},
+    {"block_read_time", &rocksdb::PerfContext::block_read_time},
+    {"block_cache_hit_count", &rocksdb::PerfContext::block_cache_hit_count},
+    {"get_from_memtable_time", &rocksdb::PerfContext::get_from_memtable_time},
+    {"get_from_output_files_time", &rocksdb::PerfContext::get_from_output_files_time},
+    {"write_wal_time", &rocksdb::PerfContext::write_wal_time},
+    {"write_memtable_time", &rocksdb::PerfContext::write_memtable_time},
+    {"write_delay_time", &rocksdb::PerfContext::write_delay_time},
+    {"key_lock_wait_count", &rocksdb::PerfContext::key_lock_wait_count},
+    {"key_lock_wait_time", &rocksdb::PerfContext::key_lock_wait_time},
+  };
+  const size_t kNumPerfFields = sizeof(kPerfFields) / sizeof(kPerfFields[0]);
+
+  // sums over the sampled operations of the current phase
+  static std::atomic<uint64_t> perf_samples{0};
+  static std::atomic<uint64_t> perf_sums[kNumPerfFields];
+  static std::atomic<uint64_t> perf_io_bytes_read{0};
+  static std::atomic<uint64_t> perf_io_bytes_written{0};
+
+  // integrated BlobDB: values of at least min_blob_size go to blob files
+  const std::string PROP_ENABLE_BLOB_FILES = "rocksdb.enable_blob_files";
+  const std::string PROP_ENABLE_BLOB_FILES_DEFAULT = "false";
+
+  const std::string PROP_MIN_BLOB_SIZE = "rocksdb.min_blob_size";
+  const std::string PROP_MIN_BLOB_SIZE_DEFAULT = "0";
+
+  const std::string PROP_BLOB_FILE_SIZE = "rocksdb.blob_file_size";
+  const std::string PROP_BLOB_FILE_SIZE_DEFAULT = "0";
+
+  const std::string PROP_BLOB_GC = "rocksdb.enable_blob_garbage_collection";
+  const std::string PROP_BLOB_GC_DEFAULT = "false";
+
+  const std::string PROP_BLOB_GC_AGE_CUTOFF = "rocksdb.blob_garbage_collection_age_cutoff";
+  const std::string PROP_BLOB_GC_AGE_CUTOFF_DEFAULT = "0.25";
+
+  static bool blob_files = false;
+
+  // blob file state of the last open database, reported by EmitStats()
+  const std::vector<std::string> kBlobProperties = {
+    "rocksdb.num-blob-files",
+    "rocksdb.total-blob-file-size",
+    "rocksdb.live-blob-file-size",
+#if ROCKSDB_MAJOR >= 7
+    "rocksdb.live-blob-file-garbage-size",
+#endif
+  };
+  static std::map<std::string, uint64_t> blob_properties;
+
+  // secondary instance that tails the primary's MANIFEST and WAL
+  const std::string PROP_SECONDARY_PATH = "rocksdb.secondary_path";
+  const std::string PROP_SECONDARY_PATH_DEFAULT = "";
+
+  // client threads that read from the secondary, the others read from the primary
+  const std::string PROP_SECONDARY_THREADS = "rocksdb.secondary_threads";
+  const std::string PROP_SECONDARY_THREADS_DEFAULT = "0";
+
+  // false opens only the secondary, e.g. in a second ycsb process next to the
+  // writer; all client threads then read from it and writes are not supported
+  const std::string PROP_OPEN_PRIMARY = "rocksdb.open_primary";
+  const std::string PROP_OPEN_PRIMARY_DEFAULT = "true";
+
+  const std::string PROP_CATCHUP_INTERVAL_MS = "rocksdb.catchup_interval_ms";
+  const std::string PROP_CATCHUP_INTERVAL_MS_DEFAULT = "100";
+
+  // none, pessimistic (TransactionDB) or optimistic (OptimisticTransactionDB)
+  const std::string PROP_TXN = "rocksdb.txn";
+  const std::string PROP_TXN_DEFAULT = "none";
+
+  // pessimistic: how long a transaction waits for a row lock
+  const std::string PROP_TXN_LOCK_TIMEOUT_MS = "rocksdb.txn_lock_timeout_ms";
+  const std::string PROP_TXN_LOCK_TIMEOUT_MS_DEFAULT = "1000";
+
+  const std::string PROP_TXN_DEADLOCK_DETECT = "rocksdb.txn_deadlock_detect";
+  const std::string PROP_TXN_DEADLOCK_DETECT_DEFAULT = "false";
+
+  // validate against a snapshot taken at BeginTransaction()
+  const std::string PROP_TXN_SET_SNAPSHOT = "rocksdb.txn_set_snapshot";
+  const std::string PROP_TXN_SET_SNAPSHOT_DEFAULT = "false";
+
+  // reads in a transaction lock (pessimistic) or track (optimistic) their keys;
+  // the read of a read-modify-write always does
+  const std::string PROP_TXN_GET_FOR_UPDATE = "rocksdb.txn_get_for_update";
+  const std::string PROP_TXN_GET_FOR_UPDATE_DEFAULT = "true";
+
+  static std::string txn_mode = "none";
+
+  // why operations and commits inside transactions of the current phase failed
+  static std::atomic<uint64_t> txn_busy{0};
+  static std::atomic<uint64_t> txn_timed_out{0};
+  static std::atomic<uint64_t> txn_try_again{0};
+  static std::atomic<uint64_t> txn_expired{0};
+
+  // reads and scans at snapshots of a process-wide pool of snapshot_count
+  // snapshots; a snapshot older than snapshot_lifetime_ms is replaced by the
+  // next read that picks it, and released when its last reader is done
+  const std::string PROP_SNAPSHOT_COUNT = "rocksdb.snapshot_count";
+  const std::string PROP_SNAPSHOT_COUNT_DEFAULT = "0";
+
+  const std::string PROP_SNAPSHOT_LIFETIME_MS = "rocksdb.snapshot_lifetime_ms";
+  const std::string PROP_SNAPSHOT_LIFETIME_MS_DEFAULT = "1000";
+
+  const std::string PROP_SNAPSHOT_READ_PROPORTION = "rocksdb.snapshot_read_proportion";
+  const std::string PROP_SNAPSHOT_READ_PROPORTION_DEFAULT = "1";
+
+  struct SnapshotSlot {
+    std::shared_ptr<const rocksdb::Snapshot> snapshot;
+    std::chrono::steady_clock::time_point taken;
+  };
+  static std::vector<SnapshotSlot> snapshot_pool;
+  static std::mutex snapshot_mu;
+  static int snapshot_count = 0;
+  static int snapshot_lifetime_ms = 0;
+  static std::atomic<uint64_t> snapshot_reads{0};
+  static std::atomic<uint64_t> snapshots_taken{0};
+
+  // what long-lived snapshots cost, sampled by the status line and at close
+  static uint64_t num_snapshots = 0;
+  static uint64_t oldest_snapshot_age = 0;
+  static uint64_t pending_compaction_bytes = 0;
+  static uint64_t max_pending_compaction_bytes = 0;
+
+  static int secondary_assigned = 0;
+  static std::thread catchup_thread;
+  static std::mutex catchup_mu;
+  static std::condition_variable catchup_cv;
+  static bool catchup_stop = false;
+
+  // TryCatchUpWithPrimary() calls of the current phase; lag is in sequence numbers
+  static std::atomic<uint64_t> catchup_count{0};
+  static std::atomic<uint64_t> catchup_micros{0};
+  static std::atomic<uint64_t> catchup_max_micros{0};
+  static std::atomic<uint64_t> catchup_lag{0};
+  static std::atomic<uint64_t> catchup_max_lag{0};
+  static std::atomic<uint64_t> catchup_last_lag{0};
+
+  void AtomicMax(std::atomic<uint64_t> &max, uint64_t value) {
+    uint64_t cur = max.load(std::memory_order_relaxed);
+    while (cur < value && !max.compare_exchange_weak(cur, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  static std::string bulkload_dir;
+  static size_t bulkload_buffer_size;
+  static bool bulkload_compact;
+  static std::atomic<uint64_t> bulkload_file_no{0};
+
+  // set once the database has been opened, a reopen for the run phase
+  // must not destroy what the load phase wrote
+  static bool reopen = false;
+  static std::string checkpoint_dir;
+  static bool checkpoint_create = false;
+
   static std::shared_ptr<rocksdb::Env> env_guard;
   static std::shared_ptr<rocksdb::Cache> block_cache;
 #if ROCKSDB_MAJOR < 8
@@ -114,53 +332,103 @@ namespace {
 namespace ycsbc {
 
 std::vector<rocksdb::ColumnFamilyHandle *> RocksdbDB::cf_handles_;
+std::unordered_map<std::string, rocksdb::ColumnFamilyHandle *> RocksdbDB::cf_map_;
+std::map<rocksdb::ColumnFamilyHandle *, std::vector<std::string>> RocksdbDB::bulk_files_;
+std::mutex RocksdbDB::bulk_mu_;
+bool RocksdbDB::bulk_loaded_ = false;
+double RocksdbDB::perf_sample_rate_ = 0;
 rocksdb::DB *RocksdbDB::db_ = nullptr;
+rocksdb::DB *RocksdbDB::secondary_db_ = nullptr;
+std::vector<rocksdb::ColumnFamilyHandle *> RocksdbDB::secondary_cf_handles_;
+std::unordered_map<std::string, rocksdb::ColumnFamilyHandle *> RocksdbDB::secondary_cf_map_;
+rocksdb::TransactionDB *RocksdbDB::txn_db_ = nullptr;
+rocksdb::OptimisticTransactionDB *RocksdbDB::otxn_db_ = nullptr;
 int RocksdbDB::ref_cnt_ = 0;
 std::mutex RocksdbDB::mu_;
 
-void RocksdbDB::Init() {
-// merge operator disabled by default due to link error
-#ifdef USE_MERGEUPDATE
-  class YCSBUpdateMerge : public rocksdb::AssociativeMergeOperator {
-   public:
-    virtual bool Merge(const rocksdb::Slice &key, const rocksdb::Slice *existing_value,
-                       const rocksdb::Slice &second, std::string *new_value,
-                       rocksdb::Logger *logger) const override {
-      assert(existing_value);
-
-      std::vector<Field> values;
-      const char *p = existing_value->data();
-      const char *lim = p + existing_value->size();
-      DeserializeRow(values, p, lim);
-
-      std::vector<Field> new_values;
-      p = second.data();
-      lim = p + second.size();
-      DeserializeRow(new_values, p, lim);
-
-      for (Field &new_field : new_values) {
-        bool found = false;
-        for (Field &field : values) {
-          if (field.first == new_field.first) {
-            found = true;
-            field.second = new_field.second;
-            break;
-          }
-        }
-        if (!found) {
-          values.push_back(new_field);
-        }
-      }
+namespace {
+
+///
+/// Row format prefix extractor: "<key>:<field>" maps to "<key>:", so all
+/// fields of one row, and only those, share a prefix whatever the key width.
+///
+class RowKeyPrefix : public rocksdb::SliceTransform {
+ public:
+  const char *Name() const override { return "ycsb.RowKeyPrefix"; }
+
+  rocksdb::Slice Transform(const rocksdb::Slice &key) const override {
+    const char *sep = static_cast<const char *>(memchr(key.data(), ':', key.size()));
+    return rocksdb::Slice(key.data(), sep - key.data() + 1);
+  }
+
+  bool InDomain(const rocksdb::Slice &key) const override {
+    return memchr(key.data(), ':', key.size()) != nullptr;
+  }
+
+  bool InRange(const rocksdb::Slice &prefix) const override {
+    return prefix.size() > 0 && memchr(prefix.data(), ':', prefix.size()) == prefix.data() + prefix.size() - 1;
+  }
+};
 
-      SerializeRow(values, *new_value);
-      return true;
+} // anonymous
+
+///
+/// Merges field updates into a serialized row. An operand is a serialized
+/// partial row whose fields overwrite those of the value below it, so
+/// operands stacked on one key collapse into one before the base is read.
+///
+class RocksdbDB::UpdateMerge : public rocksdb::MergeOperator {
+ public:
+  bool FullMergeV2(const MergeOperationInput &merge_in, MergeOperationOutput *merge_out) const override {
+    std::vector<Field> values;
+    if (merge_in.existing_value != nullptr) {
+      const char *p = merge_in.existing_value->data();
+      DeserializeRow(values, p, p + merge_in.existing_value->size());
+    }
+    for (const rocksdb::Slice &operand : merge_in.operand_list) {
+      Apply(values, operand);
     }
+    merge_out->new_value.clear();
+    SerializeRow(values, merge_out->new_value);
+    return true;
+  }
 
-    virtual const char *Name() const override {
-      return "YCSBUpdateMerge";
+  bool PartialMergeMulti(const rocksdb::Slice &key, const std::deque<rocksdb::Slice> &operand_list,
+                         std::string *new_value, rocksdb::Logger *logger) const override {
+    std::vector<Field> values;
+    for (const rocksdb::Slice &operand : operand_list) {
+      Apply(values, operand);
     }
-  };
-#endif
+    new_value->clear();
+    SerializeRow(values, *new_value);
+    return true;
+  }
+
+  const char *Name() const override {
+    return "YCSBUpdateMerge";
+  }
+
+ private:
+  static void Apply(std::vector<Field> &values, const rocksdb::Slice &operand) {
+    std::vector<Field> new_values;
+    DeserializeRow(new_values, operand.data(), operand.data() + operand.size());
+    for (Field &new_field : new_values) {
+      bool found = false;
+      for (Field &field : values) {
+        if (field.first == new_field.first) {
+          found = true;
+          field.second = std::move(new_field.second);
+          break;
+        }
+      }
+      if (!found) {
+        values.push_back(std::move(new_field));
+      }
+    }
+  }
+};
+
+void RocksdbDB::Init() {
   const std::lock_guard<std::mutex> lock(mu_);
 
   const utils::Properties &props = *props_;
@@ -172,19 +440,77 @@ void RocksdbDB::Init() {
     method_update_ = &RocksdbDB::UpdateSingle;
     method_insert_ = &RocksdbDB::InsertSingle;
     method_delete_ = &RocksdbDB::DeleteSingle;
-#ifdef USE_MERGEUPDATE
     if (props.GetProperty(PROP_MERGEUPDATE, PROP_MERGEUPDATE_DEFAULT) == "true") {
       method_update_ = &RocksdbDB::MergeSingle;
     }
-#endif
+  } else if (format == "row") {
+    format_ = kRowMajor;
+    method_read_ = &RocksdbDB::ReadCompKeyRM;
+    method_scan_ = &RocksdbDB::ScanCompKeyRM;
+    method_update_ = &RocksdbDB::InsertCompKey;
+    method_insert_ = &RocksdbDB::InsertCompKey;
+    method_delete_ = &RocksdbDB::DeleteCompKey;
+  } else if (format == "column") {
+    format_ = kColumnMajor;
+    method_read_ = &RocksdbDB::ReadCompKeyCM;
+    method_scan_ = &RocksdbDB::ScanCompKeyCM;
+    method_update_ = &RocksdbDB::InsertCompKey;
+    method_insert_ = &RocksdbDB::InsertCompKey;
+    method_delete_ = &RocksdbDB::DeleteCompKey;
   } else {
     throw utils::Exception("unknown format");
   }
   fieldcount_ = std::stoi(props.GetProperty(CoreWorkload::FIELD_COUNT_PROPERTY,
                                             CoreWorkload::FIELD_COUNT_DEFAULT));
+  field_prefix_ = props.GetProperty(CoreWorkload::FIELD_NAME_PREFIX,
+                                    CoreWorkload::FIELD_NAME_PREFIX_DEFAULT);
+
+  if (props.GetProperty(PROP_SCAN_UPPER_BOUND, PROP_SCAN_UPPER_BOUND_DEFAULT) == "true" &&
+      props.GetProperty(CoreWorkload::INSERT_ORDER_PROPERTY, CoreWorkload::INSERT_ORDER_DEFAULT) != "ordered") {
+    throw utils::Exception(PROP_SCAN_UPPER_BOUND + " needs " + CoreWorkload::INSERT_ORDER_PROPERTY + "=ordered");
+  }
+  scanner_.Init(props, format_ == kRowMajor);
+
+  // only the load phase of a fresh database is bulk loaded
+  bulkload_ = props.GetProperty(PROP_BULKLOAD, PROP_BULKLOAD_DEFAULT) == "true" &&
+              props.GetProperty("doload", "false") == "true" && !bulk_loaded_;
+  if (bulkload_) {
+    method_insert_ = &RocksdbDB::InsertBulk;
+  }
+
+  const bool open_primary = props.GetProperty(PROP_OPEN_PRIMARY, PROP_OPEN_PRIMARY_DEFAULT) == "true";
+  const std::string secondary_path = props.GetProperty(PROP_SECONDARY_PATH, PROP_SECONDARY_PATH_DEFAULT);
+  if (!open_primary && secondary_path.empty()) {
+    throw utils::Exception(PROP_OPEN_PRIMARY + "=false needs " + PROP_SECONDARY_PATH);
+  }
+  secondary_ = !secondary_path.empty() &&
+               (!open_primary || secondary_assigned++ < std::stoi(props.GetProperty(PROP_SECONDARY_THREADS,
+                                                                                    PROP_SECONDARY_THREADS_DEFAULT)));
+  const std::string txn = props.GetProperty(PROP_TXN, PROP_TXN_DEFAULT);
+  if (txn != "none" && txn != "pessimistic" && txn != "optimistic") {
+    throw utils::Exception("unknown " + PROP_TXN + ": " + txn);
+  }
+  if (txn != "none" && (format_ != kSingleRow || !open_primary)) {
+    throw utils::Exception(PROP_TXN + " needs " + PROP_FORMAT + "=single and " + PROP_OPEN_PRIMARY + "=true");
+  }
+  txn_options_.lock_timeout = std::stoll(props.GetProperty(PROP_TXN_LOCK_TIMEOUT_MS,
+                                                           PROP_TXN_LOCK_TIMEOUT_MS_DEFAULT));
+  txn_options_.deadlock_detect = props.GetProperty(PROP_TXN_DEADLOCK_DETECT,
+                                                   PROP_TXN_DEADLOCK_DETECT_DEFAULT) == "true";
+  txn_options_.set_snapshot = props.GetProperty(PROP_TXN_SET_SNAPSHOT, PROP_TXN_SET_SNAPSHOT_DEFAULT) == "true";
+  txn_get_for_update_ = props.GetProperty(PROP_TXN_GET_FOR_UPDATE, PROP_TXN_GET_FOR_UPDATE_DEFAULT) == "true";
+  snapshot_read_proportion_ = std::stod(props.GetProperty(PROP_SNAPSHOT_READ_PROPORTION,
+                                                          PROP_SNAPSHOT_READ_PROPORTION_DEFAULT));
+
+  if (!open_primary) {
+    method_update_ = &RocksdbDB::UpdateReadOnly;
+    method_insert_ = &RocksdbDB::UpdateReadOnly;
+    method_delete_ = &RocksdbDB::DeleteReadOnly;
+    bulkload_ = false;
+  }
 
   ref_cnt_++;
-  if (db_) {
+  if (db_ || secondary_db_) {
     return;
   }
 
@@ -197,20 +523,98 @@ void RocksdbDB::Init() {
   opt.create_if_missing = true;
   std::vector<rocksdb::ColumnFamilyDescriptor> cf_descs;
   GetOptions(props, &opt, &cf_descs);
-#ifdef USE_MERGEUPDATE
-  opt.merge_operator.reset(new YCSBUpdateMerge);
+  // always set: operands left by an earlier mergeupdate run are only read
+  // back through it, and it is inert without Merge() calls
+  opt.merge_operator = std::make_shared<UpdateMerge>();
+  for (rocksdb::ColumnFamilyDescriptor &desc : cf_descs) {
+    desc.options.merge_operator = opt.merge_operator;
+  }
+#if ROCKSDB_MAJOR > 6 || (ROCKSDB_MAJOR == 6 && ROCKSDB_MINOR >= 18)
+  blob_files = opt.enable_blob_files;
+  for (const rocksdb::ColumnFamilyDescriptor &desc : cf_descs) {
+    blob_files = blob_files || desc.options.enable_blob_files;
+  }
 #endif
+  if (format_ == kRowMajor && !opt.prefix_extractor) {
+    // whole-row reads are prefix seeks over "<key>:"
+    size_t prefix_len = std::stoul(props.GetProperty(PROP_ROW_PREFIX_LENGTH, PROP_ROW_PREFIX_LENGTH_DEFAULT));
+    if (prefix_len == 0) {
+      opt.prefix_extractor = std::make_shared<RowKeyPrefix>();
+    } else {
+      opt.prefix_extractor.reset(rocksdb::NewCappedPrefixTransform(prefix_len));
+    }
+  }
+
+  // one column family per workload table, sharing the block cache
+  const std::vector<std::string> tables = MultiTableWorkload::TableNames(props);
+  if (!tables.empty()) {
+    if (cf_descs.empty()) {
+      cf_descs.emplace_back(rocksdb::kDefaultColumnFamilyName, rocksdb::ColumnFamilyOptions(opt));
+    }
+    for (const std::string &table : tables) {
+      bool found = false;
+      for (const rocksdb::ColumnFamilyDescriptor &desc : cf_descs) {
+        found = found || desc.name == table;
+      }
+      if (!found) {
+        cf_descs.emplace_back(table, rocksdb::ColumnFamilyOptions(opt));
+      }
+    }
+    opt.create_missing_column_families = true;
+  }
   opt.stats_dump_period_sec = 10;
+  if (props.GetProperty(PROP_STATISTICS, PROP_STATISTICS_DEFAULT) == "true") {
+    // kept across a reopen, EmitStats() resets it after each phase
+    if (!statistics) {
+      statistics = rocksdb::CreateDBStatistics();
+    }
+    opt.statistics = statistics;
+  }
+  perf_sample_rate_ = std::stod(props.GetProperty(PROP_PERF_SAMPLE_RATE, PROP_PERF_SAMPLE_RATE_DEFAULT));
   opt.wal_dir = db_path + "/wal";
 
+  if (!open_primary) {
+    OpenSecondary(props, opt, db_path, cf_descs);
+    return;
+  }
+
+  const bool do_load = props.GetProperty("doload", "false") == "true";
+  const std::string checkpoint = props.GetProperty(PROP_CHECKPOINT, PROP_CHECKPOINT_DEFAULT);
+  checkpoint_dir = props.GetProperty(PROP_CHECKPOINT_DIR, PROP_CHECKPOINT_DIR_DEFAULT);
+  if (checkpoint != "auto" && checkpoint != "create" && checkpoint != "restore" && checkpoint != "none") {
+    throw utils::Exception("unknown " + PROP_CHECKPOINT + ": " + checkpoint);
+  }
+  const bool checkpoint_restore = !reopen && !checkpoint_dir.empty() &&
+                                  (checkpoint == "restore" || (checkpoint == "auto" && !do_load));
+  checkpoint_create = !reopen && !checkpoint_dir.empty() &&
+                      (checkpoint == "create" || (checkpoint == "auto" && do_load));
+
   rocksdb::Status s;
-  if (props.GetProperty(PROP_DESTROY, PROP_DESTROY_DEFAULT) == "true") {
+  if (checkpoint_restore) {
+    RestoreRocksdbCheckpoint(checkpoint_dir, db_path);
+  } else if (props.GetProperty(PROP_DESTROY, PROP_DESTROY_DEFAULT) == "true" && !reopen) {
     s = rocksdb::DestroyDB(db_path, opt);
     if (!s.ok()) {
       throw utils::Exception(std::string("RocksDB DestroyDB: ") + s.ToString());
     }
   }
-  if (cf_descs.empty()) {
+  if (txn == "pessimistic") {
+    rocksdb::TransactionDBOptions txn_db_opt;
+    txn_db_opt.transaction_lock_timeout = txn_options_.lock_timeout;
+    if (cf_descs.empty()) {
+      s = rocksdb::TransactionDB::Open(opt, txn_db_opt, db_path, &txn_db_);
+    } else {
+      s = rocksdb::TransactionDB::Open(opt, txn_db_opt, db_path, cf_descs, &cf_handles_, &txn_db_);
+    }
+    db_ = txn_db_;
+  } else if (txn == "optimistic") {
+    if (cf_descs.empty()) {
+      s = rocksdb::OptimisticTransactionDB::Open(opt, db_path, &otxn_db_);
+    } else {
+      s = rocksdb::OptimisticTransactionDB::Open(opt, db_path, cf_descs, &cf_handles_, &otxn_db_);
+    }
+    db_ = otxn_db_;
+  } else if (cf_descs.empty()) {
     s = rocksdb::DB::Open(opt, db_path, &db_);
   } else {
     s = rocksdb::DB::Open(opt, db_path, cf_descs, &cf_handles_, &db_);
@@ -218,20 +622,408 @@ void RocksdbDB::Init() {
   if (!s.ok()) {
     throw utils::Exception(std::string("RocksDB Open: ") + s.ToString());
   }
+  txn_mode = txn;
+
+  snapshot_count = std::stoi(props.GetProperty(PROP_SNAPSHOT_COUNT, PROP_SNAPSHOT_COUNT_DEFAULT));
+  snapshot_lifetime_ms = std::stoi(props.GetProperty(PROP_SNAPSHOT_LIFETIME_MS, PROP_SNAPSHOT_LIFETIME_MS_DEFAULT));
+  snapshot_pool.assign(snapshot_count, SnapshotSlot());
+  for (rocksdb::ColumnFamilyHandle *cf : cf_handles_) {
+    cf_map_[cf->GetName()] = cf;
+  }
+  reopen = true;
+
+  if (bulkload_) {
+    bulkload_dir = props.GetProperty(PROP_BULKLOAD_DIR, PROP_BULKLOAD_DIR_DEFAULT);
+    if (bulkload_dir.empty()) {
+      bulkload_dir = db_path + "/bulkload";
+    }
+    bulkload_buffer_size = std::stoull(props.GetProperty(PROP_BULKLOAD_BUFFER_SIZE,
+                                                         PROP_BULKLOAD_BUFFER_SIZE_DEFAULT));
+    bulkload_compact = props.GetProperty(PROP_BULKLOAD_COMPACT, PROP_BULKLOAD_COMPACT_DEFAULT) == "true";
+    s = db_->GetEnv()->CreateDirIfMissing(bulkload_dir);
+    if (!s.ok()) {
+      throw utils::Exception(std::string("RocksDB CreateDirIfMissing: ") + s.ToString());
+    }
+  }
+
+  if (!secondary_path.empty()) {
+    OpenSecondary(props, opt, db_path, cf_descs);
+  }
+}
+
+void RocksdbDB::OpenSecondary(const utils::Properties &props, rocksdb::Options opt, const std::string &db_path,
+                              const std::vector<rocksdb::ColumnFamilyDescriptor> &cf_descs) {
+  const std::string secondary_path = props.GetProperty(PROP_SECONDARY_PATH, PROP_SECONDARY_PATH_DEFAULT);
+  // a secondary keeps all table files open, the primary may delete them at any time
+  opt.max_open_files = -1;
+  rocksdb::Status s;
+  if (cf_descs.empty()) {
+    s = rocksdb::DB::OpenAsSecondary(opt, db_path, secondary_path, &secondary_db_);
+  } else {
+    s = rocksdb::DB::OpenAsSecondary(opt, db_path, secondary_path, cf_descs, &secondary_cf_handles_,
+                                     &secondary_db_);
+  }
+  if (!s.ok()) {
+    throw utils::Exception(std::string("RocksDB OpenAsSecondary: ") + s.ToString());
+  }
+  for (rocksdb::ColumnFamilyHandle *cf : secondary_cf_handles_) {
+    secondary_cf_map_[cf->GetName()] = cf;
+  }
+
+  const int interval_ms = std::stoi(props.GetProperty(PROP_CATCHUP_INTERVAL_MS, PROP_CATCHUP_INTERVAL_MS_DEFAULT));
+  catchup_stop = false;
+  catchup_thread = std::thread(CatchUpWithPrimary, interval_ms);
+}
+
+void RocksdbDB::CatchUpWithPrimary(int interval_ms) {
+  std::unique_lock<std::mutex> lock(catchup_mu);
+  while (!catchup_cv.wait_for(lock, std::chrono::milliseconds(interval_ms), [] { return catchup_stop; })) {
+    const uint64_t before = secondary_db_->GetLatestSequenceNumber();
+    const uint64_t primary = db_ ? db_->GetLatestSequenceNumber() : 0;
+    const auto start = std::chrono::steady_clock::now();
+    rocksdb::Status s = secondary_db_->TryCatchUpWithPrimary();
+    const uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    if (!s.ok()) {
+      std::cerr << "RocksDB TryCatchUpWithPrimary: " << s.ToString() << std::endl;
+      continue;
+    }
+    // how far the secondary trailed: the primary's lead when it is in this
+    // process, otherwise what the catch-up replayed
+    const uint64_t after = secondary_db_->GetLatestSequenceNumber();
+    const uint64_t lag = db_ ? (primary > before ? primary - before : 0) : after - before;
+    catchup_count.fetch_add(1, std::memory_order_relaxed);
+    catchup_micros.fetch_add(micros, std::memory_order_relaxed);
+    AtomicMax(catchup_max_micros, micros);
+    catchup_lag.fetch_add(lag, std::memory_order_relaxed);
+    AtomicMax(catchup_max_lag, lag);
+    catchup_last_lag.store(lag, std::memory_order_relaxed);
+  }
+}
+
+bool RocksdbDB::ReInitBeforeTransaction() {
+  // the last Cleanup() of the load phase ingests the bulk loaded files and
+  // takes the checkpoint
+  const std::string checkpoint = props_->GetProperty(PROP_CHECKPOINT, PROP_CHECKPOINT_DEFAULT);
+  return props_->GetProperty(PROP_BULKLOAD, PROP_BULKLOAD_DEFAULT) == "true" ||
+         (props_->GetProperty(PROP_CHECKPOINT_DIR, PROP_CHECKPOINT_DIR_DEFAULT) != "" &&
+          (checkpoint == "auto" || checkpoint == "create"));
 }
 
 void RocksdbDB::Cleanup() { 
+  scanner_.Clear();
+  // an unfinished transaction is rolled back
+  delete txn_;
+  txn_ = nullptr;
+  in_txn_ = false;
+  if (bulkload_) {
+    WriteBulkFiles();
+  }
   const std::lock_guard<std::mutex> lock(mu_);
   if (--ref_cnt_) {
     return;
   }
+  if (bulkload_) {
+    IngestBulkFiles();
+  }
+  if (checkpoint_create) {
+    CreateRocksdbCheckpoint(db_, checkpoint_dir);
+    checkpoint_create = false;
+  }
+  if (secondary_db_) {
+    {
+      const std::lock_guard<std::mutex> catchup_lock(catchup_mu);
+      catchup_stop = true;
+    }
+    catchup_cv.notify_all();
+    catchup_thread.join();
+    for (rocksdb::ColumnFamilyHandle *cf : secondary_cf_handles_) {
+      delete cf;
+    }
+    secondary_cf_handles_.clear();
+    secondary_cf_map_.clear();
+    delete secondary_db_;
+    secondary_db_ = nullptr;
+  }
+  secondary_assigned = 0;
+  if (blob_files && db_) {
+    CollectBlobProperties();
+  }
+  if (snapshot_count > 0 && db_) {
+    CollectSnapshotProperties();
+  }
+  snapshot_pool.clear();
   for (size_t i = 0; i < cf_handles_.size(); i++) {
     if (cf_handles_[i] != nullptr) {
       delete cf_handles_[i];
       cf_handles_[i] = nullptr;
     }
   }
+  cf_handles_.clear();
+  cf_map_.clear();
   delete db_;
+  db_ = nullptr;
+  txn_db_ = nullptr;
+  otxn_db_ = nullptr;
+}
+
+std::string RocksdbDB::GetStatusMsg() {
+  std::ostringstream msg_stream;
+  msg_stream.precision(2);
+  msg_stream << std::fixed;
+  if (statistics) {
+    std::vector<uint64_t> tickers;
+    for (const auto &ticker : kStatusTickers) {
+      tickers.push_back(statistics->getTickerCount(ticker.first));
+    }
+    if (status_tickers_.size() != tickers.size()) {
+      status_tickers_.assign(tickers.size(), 0);
+    }
+    std::vector<uint64_t> period(tickers.size());
+    for (size_t i = 0; i < tickers.size(); i++) {
+      // counters restart from zero when EmitStats() resets them
+      period[i] = tickers[i] >= status_tickers_[i] ? tickers[i] - status_tickers_[i] : tickers[i];
+    }
+    status_tickers_ = tickers;
+
+    msg_stream << "[ROCKSDB: Period";
+    for (size_t i = 0; i < period.size(); i++) {
+      msg_stream << ' ' << kStatusTickers[i].second << '=' << period[i];
+    }
+    const uint64_t lookups = period[1] + period[2];
+    msg_stream << " CacheHitRate=" << (lookups > 0 ? 100.0 * period[1] / lookups : 0) << "%]";
+  }
+  if (secondary_db_) {
+    const uint64_t count = catchup_count.load(std::memory_order_relaxed);
+    const uint64_t micros = catchup_micros.load(std::memory_order_relaxed);
+    const uint64_t period_count = count >= status_catchups_ ? count - status_catchups_ : count;
+    const uint64_t period_micros = micros >= status_catchup_micros_ ? micros - status_catchup_micros_ : micros;
+    status_catchups_ = count;
+    status_catchup_micros_ = micros;
+
+    if (statistics) {
+      msg_stream << ' ';
+    }
+    msg_stream << "[ROCKSDB-SECONDARY: Period CatchUps=" << period_count
+               << " AvgCatchUpMicros=" << (period_count > 0 ? static_cast<double>(period_micros) / period_count : 0)
+               << " LastLag=" << catchup_last_lag.load(std::memory_order_relaxed) << ']';
+  }
+  if (snapshot_count > 0) {
+    const std::lock_guard<std::mutex> lock(mu_);
+    if (db_) {
+      CollectSnapshotProperties();
+      if (msg_stream.tellp() > 0) {
+        msg_stream << ' ';
+      }
+      msg_stream << "[ROCKSDB-SNAPSHOTS: Held=" << num_snapshots << " OldestAgeSec=" << oldest_snapshot_age
+                 << " PendingCompactionBytes=" << pending_compaction_bytes << ']';
+    }
+  }
+  return msg_stream.str();
+}
+
+void RocksdbDB::EmitStats(YAML::Node &node) {
+  YAML::Node rocksdb_node;
+  if (statistics) {
+    std::map<std::string, uint64_t> ticker_map;
+    statistics->getTickerMap(&ticker_map);
+    YAML::Node tickers_node;
+    for (const auto &ticker : ticker_map) {
+      if (ticker.second > 0) {
+        tickers_node[ticker.first] = ticker.second;
+      }
+    }
+    rocksdb_node["tickers"] = tickers_node;
+
+    YAML::Node histograms_node;
+    for (const auto &histogram : rocksdb::HistogramsNameMap) {
+      rocksdb::HistogramData data;
+      statistics->histogramData(histogram.first, &data);
+      if (data.count == 0) {
+        continue;
+      }
+      YAML::Node histogram_node;
+      histogram_node["count"] = data.count;
+      histogram_node["avg"] = data.average;
+      histogram_node["p50"] = data.median;
+      histogram_node["p95"] = data.percentile95;
+      histogram_node["p99"] = data.percentile99;
+      histogram_node["max"] = data.max;
+      histograms_node[histogram.second] = histogram_node;
+    }
+    rocksdb_node["histograms"] = histograms_node;
+
+    const uint64_t hits = statistics->getTickerCount(rocksdb::BLOCK_CACHE_HIT);
+    const uint64_t misses = statistics->getTickerCount(rocksdb::BLOCK_CACHE_MISS);
+    rocksdb_node["block_cache_hit_rate"] = hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0;
+    rocksdb_node["stall_micros"] = statistics->getTickerCount(rocksdb::STALL_MICROS);
+    rocksdb_node["bytes_read"] = statistics->getTickerCount(rocksdb::BYTES_READ);
+    rocksdb_node["bytes_written"] = statistics->getTickerCount(rocksdb::BYTES_WRITTEN);
+    rocksdb_node["compact_read_bytes"] = statistics->getTickerCount(rocksdb::COMPACT_READ_BYTES);
+    rocksdb_node["compact_write_bytes"] = statistics->getTickerCount(rocksdb::COMPACT_WRITE_BYTES);
+    if (blob_files) {
+      YAML::Node blob_node;
+      blob_node["blob_bytes_read"] = statistics->getTickerCount(rocksdb::BLOB_DB_BLOB_FILE_BYTES_READ);
+      blob_node["blob_bytes_written"] = statistics->getTickerCount(rocksdb::BLOB_DB_BLOB_FILE_BYTES_WRITTEN);
+      blob_node["gc_keys_relocated"] = statistics->getTickerCount(rocksdb::BLOB_DB_GC_NUM_KEYS_RELOCATED);
+      blob_node["gc_bytes_relocated"] = statistics->getTickerCount(rocksdb::BLOB_DB_GC_BYTES_RELOCATED);
+      rocksdb_node["blob"] = blob_node;
+    }
+    statistics->Reset();
+    status_tickers_.clear();
+  }
+
+  if (blob_files) {
+    const std::lock_guard<std::mutex> lock(mu_);
+    if (db_) {
+      CollectBlobProperties();
+    }
+    YAML::Node blob_node = rocksdb_node["blob"];
+    for (const auto &property : blob_properties) {
+      blob_node[property.first.substr(std::string("rocksdb.").size())] = property.second;
+    }
+    rocksdb_node["blob"] = blob_node;
+  }
+
+  // the counters outlive the secondary, which is closed before the run summary
+  if (catchup_count.load() > 0) {
+    const uint64_t count = catchup_count.exchange(0);
+    YAML::Node secondary_node;
+    secondary_node["catchups"] = count;
+    secondary_node["avg_catchup_us"] = count > 0 ? static_cast<double>(catchup_micros.exchange(0)) / count : 0.0;
+    secondary_node["max_catchup_us"] = catchup_max_micros.exchange(0);
+    secondary_node["avg_lag_seq"] = count > 0 ? static_cast<double>(catchup_lag.exchange(0)) / count : 0.0;
+    secondary_node["max_lag_seq"] = catchup_max_lag.exchange(0);
+    rocksdb_node["secondary"] = secondary_node;
+    status_catchups_ = 0;
+    status_catchup_micros_ = 0;
+  }
+
+  if (snapshot_count > 0) {
+    const std::lock_guard<std::mutex> lock(mu_);
+    if (db_) {
+      CollectSnapshotProperties();
+    }
+    YAML::Node snapshot_node;
+    snapshot_node["reads"] = snapshot_reads.exchange(0);
+    snapshot_node["taken"] = snapshots_taken.exchange(0);
+    snapshot_node["num_snapshots"] = num_snapshots;
+    snapshot_node["oldest_snapshot_age_sec"] = oldest_snapshot_age;
+    snapshot_node["pending_compaction_bytes"] = pending_compaction_bytes;
+    snapshot_node["max_pending_compaction_bytes"] = max_pending_compaction_bytes;
+    max_pending_compaction_bytes = 0;
+    rocksdb_node["snapshots"] = snapshot_node;
+  }
+
+  if (txn_mode != "none") {
+    YAML::Node txn_node;
+    txn_node["mode"] = txn_mode;
+    txn_node["busy"] = txn_busy.exchange(0);
+    txn_node["lock_timeouts"] = txn_timed_out.exchange(0);
+    txn_node["try_again"] = txn_try_again.exchange(0);
+    txn_node["expired"] = txn_expired.exchange(0);
+    rocksdb_node["transactions"] = txn_node;
+  }
+
+  const uint64_t samples = perf_samples.exchange(0);
+  if (samples > 0) {
+    // per-operation averages; times are in nanoseconds
+    YAML::Node perf_node;
+    perf_node["samples"] = samples;
+    for (size_t i = 0; i < kNumPerfFields; i++) {
+      perf_node[kPerfFields[i].name] = static_cast<double>(perf_sums[i].exchange(0)) / samples;
+    }
+    perf_node["io_bytes_read"] = static_cast<double>(perf_io_bytes_read.exchange(0)) / samples;
+    perf_node["io_bytes_written"] = static_cast<double>(perf_io_bytes_written.exchange(0)) / samples;
+    rocksdb_node["perf_context"] = perf_node;
+  }
+
+  if (rocksdb_node.size() > 0) {
+    node["rocksdb"] = rocksdb_node;
+  }
+}
+
+void RocksdbDB::CollectBlobProperties() {
+  blob_properties.clear();
+  std::vector<rocksdb::ColumnFamilyHandle *> cfs = cf_handles_;
+  if (cfs.empty()) {
+    cfs.push_back(db_->DefaultColumnFamily());
+  }
+  for (const std::string &property : kBlobProperties) {
+    for (rocksdb::ColumnFamilyHandle *cf : cfs) {
+      uint64_t value;
+      if (db_->GetIntProperty(cf, property, &value)) {
+        blob_properties[property] += value;
+      }
+    }
+  }
+}
+
+void RocksdbDB::CollectSnapshotProperties() {
+  if (!db_->GetIntProperty("rocksdb.num-snapshots", &num_snapshots)) {
+    num_snapshots = 0;
+  }
+  uint64_t oldest_time;
+  const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  // zero without snapshots
+  if (db_->GetIntProperty("rocksdb.oldest-snapshot-time", &oldest_time) && oldest_time > 0 &&
+      static_cast<uint64_t>(now) > oldest_time) {
+    oldest_snapshot_age = now - oldest_time;
+  } else {
+    oldest_snapshot_age = 0;
+  }
+  std::vector<rocksdb::ColumnFamilyHandle *> cfs = cf_handles_;
+  if (cfs.empty()) {
+    cfs.push_back(db_->DefaultColumnFamily());
+  }
+  pending_compaction_bytes = 0;
+  for (rocksdb::ColumnFamilyHandle *cf : cfs) {
+    uint64_t value;
+    if (db_->GetIntProperty(cf, "rocksdb.estimate-pending-compaction-bytes", &value)) {
+      pending_compaction_bytes += value;
+    }
+  }
+  max_pending_compaction_bytes = std::max(max_pending_compaction_bytes, pending_compaction_bytes);
+}
+
+std::shared_ptr<const rocksdb::Snapshot> RocksdbDB::NextSnapshot() {
+  // transactions read at their own snapshot, a secondary has none
+  if (snapshot_pool.empty() || secondary_ || in_txn_ ||
+      utils::ThreadLocalRandomDouble() >= snapshot_read_proportion_) {
+    return nullptr;
+  }
+  snapshot_reads.fetch_add(1, std::memory_order_relaxed);
+  const auto now = std::chrono::steady_clock::now();
+  const std::lock_guard<std::mutex> lock(snapshot_mu);
+  SnapshotSlot &slot = snapshot_pool[utils::ThreadLocalRandomInt() % snapshot_pool.size()];
+  if (!slot.snapshot || now - slot.taken >= std::chrono::milliseconds(snapshot_lifetime_ms)) {
+    rocksdb::DB *db = db_;
+    slot.snapshot.reset(db->GetSnapshot(), [db](const rocksdb::Snapshot *snapshot) {
+      db->ReleaseSnapshot(snapshot);
+    });
+    slot.taken = now;
+    snapshots_taken.fetch_add(1, std::memory_order_relaxed);
+  }
+  return slot.snapshot;
+}
+
+void RocksdbDB::PerfSample::Start() {
+  rocksdb::SetPerfLevel(rocksdb::PerfLevel::kEnableTimeExceptForMutex);
+  rocksdb::get_perf_context()->Reset();
+  rocksdb::get_iostats_context()->Reset();
+}
+
+void RocksdbDB::PerfSample::Stop() {
+  const rocksdb::PerfContext *perf = rocksdb::get_perf_context();
+  for (size_t i = 0; i < kNumPerfFields; i++) {
+    perf_sums[i].fetch_add(perf->*kPerfFields[i].field, std::memory_order_relaxed);
+  }
+  const rocksdb::IOStatsContext *iostats = rocksdb::get_iostats_context();
+  perf_io_bytes_read.fetch_add(iostats->bytes_read, std::memory_order_relaxed);
+  perf_io_bytes_written.fetch_add(iostats->bytes_written, std::memory_order_relaxed);
+  perf_samples.fetch_add(1, std::memory_order_relaxed);
+  rocksdb::SetPerfLevel(rocksdb::PerfLevel::kDisable);
 }
 
 void RocksdbDB::GetOptions(const utils::Properties &props, rocksdb::Options *opt,
@@ -360,6 +1152,22 @@ void RocksdbDB::GetOptions(const utils::Properties &props, rocksdb::Options *opt
     }
     opt->table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
 
+    if (props.GetProperty(PROP_ENABLE_BLOB_FILES, PROP_ENABLE_BLOB_FILES_DEFAULT) == "true") {
+#if ROCKSDB_MAJOR > 6 || (ROCKSDB_MAJOR == 6 && ROCKSDB_MINOR >= 18)
+      opt->enable_blob_files = true;
+      opt->min_blob_size = std::stoull(props.GetProperty(PROP_MIN_BLOB_SIZE, PROP_MIN_BLOB_SIZE_DEFAULT));
+      uint64_t blob_file_size = std::stoull(props.GetProperty(PROP_BLOB_FILE_SIZE, PROP_BLOB_FILE_SIZE_DEFAULT));
+      if (blob_file_size != 0) {
+        opt->blob_file_size = blob_file_size;
+      }
+      opt->enable_blob_garbage_collection = props.GetProperty(PROP_BLOB_GC, PROP_BLOB_GC_DEFAULT) == "true";
+      opt->blob_garbage_collection_age_cutoff = std::stod(props.GetProperty(PROP_BLOB_GC_AGE_CUTOFF,
+                                                                            PROP_BLOB_GC_AGE_CUTOFF_DEFAULT));
+#else
+      throw utils::Exception(PROP_ENABLE_BLOB_FILES + " needs RocksDB 6.18 or later");
+#endif
+    }
+
     if (props.GetProperty(PROP_INCREASE_PARALLELISM, PROP_INCREASE_PARALLELISM_DEFAULT) == "true") {
       opt->IncreaseParallelism();
     }
@@ -429,14 +1237,50 @@ void RocksdbDB::DeserializeRow(std::vector<Field> &values, const std::string &da
   DeserializeRow(values, p, lim);
 }
 
+std::string RocksdbDB::BuildCompKey(const std::string &key, const std::string &field_name) {
+  switch (format_) {
+    case kRowMajor:
+      return key + ":" + field_name;
+      break;
+    case kColumnMajor:
+      return field_name + ":" + key;
+      break;
+    default:
+      throw utils::Exception("wrong format");
+  }
+}
+
+std::string RocksdbDB::KeyFromCompKey(const rocksdb::Slice &comp_key) {
+  const char *sep = static_cast<const char *>(memchr(comp_key.data(), ':', comp_key.size()));
+  assert(sep != nullptr);
+  return std::string(comp_key.data(), sep - comp_key.data());
+}
+
+std::string RocksdbDB::FieldFromCompKey(const rocksdb::Slice &comp_key) {
+  const char *sep = static_cast<const char *>(memchr(comp_key.data(), ':', comp_key.size()));
+  assert(sep != nullptr);
+  return std::string(sep + 1, comp_key.data() + comp_key.size() - sep - 1);
+}
+
 DB::Status RocksdbDB::ReadSingle(const std::string &table, const std::string &key,
                                  const std::vector<std::string> *fields,
                                  std::vector<Field> &result) {
   std::string data;
-  rocksdb::Status s = db_->Get(rocksdb::ReadOptions(), key, &data);
+  rocksdb::Status s;
+  if (in_txn_) {
+    s = TxnGet(ColumnFamily(table), key, &data, txn_get_for_update_);
+  } else {
+    std::shared_ptr<const rocksdb::Snapshot> snapshot = NextSnapshot();
+    rocksdb::ReadOptions ropt;
+    ropt.snapshot = snapshot.get();
+    s = Reader()->Get(ropt, ReaderColumnFamily(table), key, &data);
+  }
   if (s.IsNotFound()) {
     return kNotFound;
   } else if (!s.ok()) {
+    if (in_txn_) {
+      return TxnFailed(s, "Get");
+    }
     throw utils::Exception(std::string("RocksDB Get: ") + s.ToString());
   }
   if (fields != nullptr) {
@@ -451,31 +1295,39 @@ DB::Status RocksdbDB::ReadSingle(const std::string &table, const std::string &ke
 DB::Status RocksdbDB::ScanSingle(const std::string &table, const std::string &key, int len,
                                  const std::vector<std::string> *fields,
                                  std::vector<std::vector<Field>> &result) {
-  rocksdb::Iterator *db_iter = db_->NewIterator(rocksdb::ReadOptions());
-  db_iter->Seek(key);
+  std::shared_ptr<const rocksdb::Snapshot> snapshot = NextSnapshot();
+  rocksdb::Iterator *db_iter = scanner_.Seek(Reader(), ReaderColumnFamily(table), key, len, snapshot.get());
   for (int i = 0; db_iter->Valid() && i < len; i++) {
-    std::string data = db_iter->value().ToString();
+    const rocksdb::Slice data = db_iter->value();
     result.push_back(std::vector<Field>());
     std::vector<Field> &values = result.back();
     if (fields != nullptr) {
-      DeserializeRowFilter(values, data, *fields);
+      DeserializeRowFilter(values, data.data(), data.data() + data.size(), *fields);
     } else {
-      DeserializeRow(values, data);
+      DeserializeRow(values, data.data(), data.data() + data.size());
       assert(values.size() == static_cast<size_t>(fieldcount_));
     }
     db_iter->Next();
   }
-  delete db_iter;
+  scanner_.Done();
   return kOK;
 }
 
 DB::Status RocksdbDB::UpdateSingle(const std::string &table, const std::string &key,
                                    std::vector<Field> &values) {
   std::string data;
-  rocksdb::Status s = db_->Get(rocksdb::ReadOptions(), key, &data);
+  rocksdb::Status s;
+  if (in_txn_) {
+    s = TxnGet(ColumnFamily(table), key, &data, true);
+  } else {
+    s = db_->Get(rocksdb::ReadOptions(), ColumnFamily(table), key, &data);
+  }
   if (s.IsNotFound()) {
     return kNotFound;
   } else if (!s.ok()) {
+    if (in_txn_) {
+      return TxnFailed(s, "GetForUpdate");
+    }
     throw utils::Exception(std::string("RocksDB Get: ") + s.ToString());
   }
   std::vector<Field> current_values;
@@ -496,7 +1348,14 @@ DB::Status RocksdbDB::UpdateSingle(const std::string &table, const std::string &
 
   data.clear();
   SerializeRow(current_values, data);
-  s = db_->Put(wopt, key, data);
+  if (in_txn_) {
+    s = txn_->Put(ColumnFamily(table), key, data);
+    if (!s.ok()) {
+      return TxnFailed(s, "Put");
+    }
+    return kOK;
+  }
+  s = db_->Put(wopt, ColumnFamily(table), key, data);
   if (!s.ok()) {
     throw utils::Exception(std::string("RocksDB Put: ") + s.ToString());
   }
@@ -508,7 +1367,15 @@ DB::Status RocksdbDB::MergeSingle(const std::string &table, const std::string &k
   std::string data;
   SerializeRow(values, data);
   rocksdb::WriteOptions wopt;
-  rocksdb::Status s = db_->Merge(wopt, key, data);
+  rocksdb::Status s;
+  if (in_txn_) {
+    s = txn_->Merge(ColumnFamily(table), key, data);
+    if (!s.ok()) {
+      return TxnFailed(s, "Merge");
+    }
+    return kOK;
+  }
+  s = db_->Merge(wopt, ColumnFamily(table), key, data);
   if (!s.ok()) {
     throw utils::Exception(std::string("RocksDB Merge: ") + s.ToString());
   }
@@ -521,7 +1388,15 @@ DB::Status RocksdbDB::InsertSingle(const std::string &table, const std::string &
   SerializeRow(values, data);
   rocksdb::WriteOptions wopt;
   // wopt.sync = true;
-  rocksdb::Status s = db_->Put(wopt, key, data);
+  rocksdb::Status s;
+  if (in_txn_) {
+    s = txn_->Put(ColumnFamily(table), key, data);
+    if (!s.ok()) {
+      return TxnFailed(s, "Put");
+    }
+    return kOK;
+  }
+  s = db_->Put(wopt, ColumnFamily(table), key, data);
   if (!s.ok()) {
     throw utils::Exception(std::string("RocksDB Put: ") + s.ToString());
   }
@@ -530,13 +1405,363 @@ DB::Status RocksdbDB::InsertSingle(const std::string &table, const std::string &
 
 DB::Status RocksdbDB::DeleteSingle(const std::string &table, const std::string &key) {
   rocksdb::WriteOptions wopt;
-  rocksdb::Status s = db_->Delete(wopt, key);
+  rocksdb::Status s;
+  if (in_txn_) {
+    s = txn_->Delete(ColumnFamily(table), key);
+    if (!s.ok()) {
+      return TxnFailed(s, "Delete");
+    }
+    return kOK;
+  }
+  s = db_->Delete(wopt, ColumnFamily(table), key);
   if (!s.ok()) {
     throw utils::Exception(std::string("RocksDB Delete: ") + s.ToString());
   }
   return kOK;
 }
 
+DB::Status RocksdbDB::InsertBulk(const std::string &table, const std::string &key,
+                                 std::vector<Field> &values) {
+  std::vector<std::pair<std::string, std::string>> &rows = bulk_buffer_[ColumnFamily(table)];
+  if (format_ == kSingleRow) {
+    std::string data;
+    SerializeRow(values, data);
+    bulk_buffer_bytes_ += key.size() + data.size();
+    rows.emplace_back(key, std::move(data));
+  } else {
+    for (Field &field : values) {
+      std::string comp_key = BuildCompKey(key, field.first);
+      bulk_buffer_bytes_ += comp_key.size() + field.second.size();
+      rows.emplace_back(std::move(comp_key), field.second);
+    }
+  }
+  if (bulk_buffer_bytes_ >= bulkload_buffer_size) {
+    WriteBulkFiles();
+  }
+  return kOK;
+}
+
+void RocksdbDB::WriteBulkFiles() {
+  for (auto &cf_rows : bulk_buffer_) {
+    std::vector<std::pair<std::string, std::string>> &rows = cf_rows.second;
+    if (rows.empty()) {
+      continue;
+    }
+    // SstFileWriter needs strictly increasing keys, the last write of a key wins
+    std::stable_sort(rows.begin(), rows.end(),
+                     [](const std::pair<std::string, std::string> &a,
+                        const std::pair<std::string, std::string> &b) { return a.first < b.first; });
+    const std::string path = bulkload_dir + "/" + std::to_string(bulkload_file_no++) + ".sst";
+    rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), db_->GetOptions(cf_rows.first), cf_rows.first);
+    rocksdb::Status s = writer.Open(path);
+    if (!s.ok()) {
+      throw utils::Exception(std::string("RocksDB SstFileWriter Open: ") + s.ToString());
+    }
+    for (size_t i = 0; i < rows.size(); i++) {
+      if (i + 1 < rows.size() && rows[i].first == rows[i + 1].first) {
+        continue;
+      }
+      s = writer.Put(rows[i].first, rows[i].second);
+      if (!s.ok()) {
+        throw utils::Exception(std::string("RocksDB SstFileWriter Put: ") + s.ToString());
+      }
+    }
+    s = writer.Finish();
+    if (!s.ok()) {
+      throw utils::Exception(std::string("RocksDB SstFileWriter Finish: ") + s.ToString());
+    }
+    rows.clear();
+
+    const std::lock_guard<std::mutex> lock(bulk_mu_);
+    bulk_files_[cf_rows.first].push_back(path);
+  }
+  bulk_buffer_bytes_ = 0;
+}
+
+void RocksdbDB::IngestBulkFiles() {
+  rocksdb::IngestExternalFileOptions ingest_opt;
+  ingest_opt.move_files = true;
+  for (auto &cf_files : bulk_files_) {
+    // files of different clients overlap, so they land in L0 and one
+    // manual compaction turns them into the fully compacted starting state
+    rocksdb::Status s = db_->IngestExternalFile(cf_files.first, cf_files.second, ingest_opt);
+    if (!s.ok()) {
+      throw utils::Exception(std::string("RocksDB IngestExternalFile: ") + s.ToString());
+    }
+    if (bulkload_compact) {
+      s = db_->CompactRange(rocksdb::CompactRangeOptions(), cf_files.first, nullptr, nullptr);
+      if (!s.ok()) {
+        throw utils::Exception(std::string("RocksDB CompactRange: ") + s.ToString());
+      }
+    }
+  }
+  bulk_files_.clear();
+  bulk_loaded_ = true;
+}
+
+DB::Status RocksdbDB::MultiGetCompKey(const std::string &table, const std::string &key,
+                                      const std::vector<std::string> &fields,
+                                      std::vector<Field> &result) {
+  std::vector<std::string> comp_keys;
+  std::vector<rocksdb::Slice> key_slices;
+  comp_keys.reserve(fields.size());
+  for (const std::string &field : fields) {
+    comp_keys.push_back(BuildCompKey(key, field));
+    key_slices.emplace_back(comp_keys.back());
+  }
+  std::vector<rocksdb::PinnableSlice> values(fields.size());
+  std::vector<rocksdb::Status> statuses(fields.size());
+  std::shared_ptr<const rocksdb::Snapshot> snapshot = NextSnapshot();
+  rocksdb::ReadOptions ropt;
+  ropt.snapshot = snapshot.get();
+  Reader()->MultiGet(ropt, ReaderColumnFamily(table), fields.size(), key_slices.data(), values.data(),
+                     statuses.data());
+  for (size_t i = 0; i < fields.size(); i++) {
+    if (statuses[i].IsNotFound()) {
+      result.clear();
+      return kNotFound;
+    } else if (!statuses[i].ok()) {
+      throw utils::Exception(std::string("RocksDB MultiGet: ") + statuses[i].ToString());
+    }
+    result.push_back({fields[i], values[i].ToString()});
+  }
+  return kOK;
+}
+
+DB::Status RocksdbDB::ReadCompKeyRM(const std::string &table, const std::string &key,
+                                    const std::vector<std::string> *fields,
+                                    std::vector<Field> &result) {
+  if (fields != nullptr) {
+    return MultiGetCompKey(table, key, *fields, result);
+  }
+  // all fields of a row share the "<key>:" prefix
+  const std::string prefix = key + ":";
+  const std::string upper = key + ";";
+  const rocksdb::Slice upper_slice(upper);
+  std::shared_ptr<const rocksdb::Snapshot> snapshot = NextSnapshot();
+  rocksdb::ReadOptions ropt;
+  ropt.snapshot = snapshot.get();
+  ropt.prefix_same_as_start = true;
+  ropt.iterate_upper_bound = &upper_slice;
+  rocksdb::Iterator *db_iter = Reader()->NewIterator(ropt, ReaderColumnFamily(table));
+  for (db_iter->Seek(prefix); db_iter->Valid(); db_iter->Next()) {
+    result.push_back({FieldFromCompKey(db_iter->key()), db_iter->value().ToString()});
+  }
+  rocksdb::Status s = db_iter->status();
+  delete db_iter;
+  if (!s.ok()) {
+    throw utils::Exception(std::string("RocksDB Iterator: ") + s.ToString());
+  }
+  if (result.empty()) {
+    return kNotFound;
+  }
+  assert(result.size() == static_cast<size_t>(fieldcount_));
+  return kOK;
+}
+
+DB::Status RocksdbDB::ScanCompKeyRM(const std::string &table, const std::string &key, int len,
+                                    const std::vector<std::string> *fields,
+                                    std::vector<std::vector<Field>> &result) {
+  std::shared_ptr<const rocksdb::Snapshot> snapshot = NextSnapshot();
+  rocksdb::Iterator *db_iter = scanner_.Seek(Reader(), ReaderColumnFamily(table), key, len, snapshot.get());
+  std::string cur_key;
+  for (; db_iter->Valid(); db_iter->Next()) {
+    std::string row_key = KeyFromCompKey(db_iter->key());
+    if (result.empty() || row_key != cur_key) {
+      if (result.size() == static_cast<size_t>(len)) {
+        break;
+      }
+      result.push_back(std::vector<Field>());
+      cur_key = std::move(row_key);
+    }
+    std::string field = FieldFromCompKey(db_iter->key());
+    if (fields == nullptr || std::find(fields->begin(), fields->end(), field) != fields->end()) {
+      result.back().push_back({std::move(field), db_iter->value().ToString()});
+    }
+  }
+  scanner_.Done();
+  return kOK;
+}
+
+DB::Status RocksdbDB::ReadCompKeyCM(const std::string &table, const std::string &key,
+                                    const std::vector<std::string> *fields,
+                                    std::vector<Field> &result) {
+  if (fields != nullptr) {
+    return MultiGetCompKey(table, key, *fields, result);
+  }
+  std::vector<std::string> all_fields;
+  for (int i = 0; i < fieldcount_; i++) {
+    all_fields.push_back(field_prefix_ + std::to_string(i));
+  }
+  return MultiGetCompKey(table, key, all_fields, result);
+}
+
+DB::Status RocksdbDB::ScanCompKeyCM(const std::string &table, const std::string &key, int len,
+                                    const std::vector<std::string> *fields,
+                                    std::vector<std::vector<Field>> &result) {
+  std::vector<std::string> scan_fields;
+  if (fields != nullptr) {
+    scan_fields = *fields;
+  } else {
+    for (int i = 0; i < fieldcount_; i++) {
+      scan_fields.push_back(field_prefix_ + std::to_string(i));
+    }
+  }
+  // one column at a time; the first column decides which rows are returned,
+  // a snapshot keeps the columns consistent with each other
+  std::shared_ptr<const rocksdb::Snapshot> snapshot = NextSnapshot();
+  if (!snapshot && scan_fields.size() > 1 && !secondary_ && !in_txn_) {
+    rocksdb::DB *db = db_;
+    snapshot.reset(db->GetSnapshot(), [db](const rocksdb::Snapshot *snapshot) {
+      db->ReleaseSnapshot(snapshot);
+    });
+  }
+  std::vector<std::string> row_keys;
+  for (size_t f = 0; f < scan_fields.size(); f++) {
+    const std::string &field = scan_fields[f];
+    const std::string prefix = field + ":";
+    rocksdb::Iterator *db_iter = scanner_.Seek(Reader(), ReaderColumnFamily(table), prefix + key, len,
+                                               snapshot.get());
+    for (int i = 0; db_iter->Valid() && db_iter->key().starts_with(prefix); db_iter->Next()) {
+      std::string row_key = FieldFromCompKey(db_iter->key());
+      if (f == 0) {
+        if (i == len) {
+          break;
+        }
+        row_keys.push_back(row_key);
+        result.push_back(std::vector<Field>());
+      } else {
+        // skip rows the first column does not have
+        while (static_cast<size_t>(i) < row_keys.size() && row_keys[i] < row_key) {
+          i++;
+        }
+        if (static_cast<size_t>(i) == row_keys.size()) {
+          break;
+        }
+        if (row_keys[i] != row_key) {
+          continue;
+        }
+      }
+      result[i].push_back({field, db_iter->value().ToString()});
+      i++;
+    }
+    scanner_.Done();
+  }
+  return kOK;
+}
+
+DB::Status RocksdbDB::InsertCompKey(const std::string &table, const std::string &key,
+                                    std::vector<Field> &values) {
+  rocksdb::WriteOptions wopt;
+  rocksdb::WriteBatch batch;
+  rocksdb::ColumnFamilyHandle *cf = ColumnFamily(table);
+
+  std::string comp_key;
+  for (Field &field : values) {
+    comp_key = BuildCompKey(key, field.first);
+    batch.Put(cf, comp_key, field.second);
+  }
+
+  rocksdb::Status s = db_->Write(wopt, &batch);
+  if (!s.ok()) {
+    throw utils::Exception(std::string("RocksDB Write: ") + s.ToString());
+  }
+  return kOK;
+}
+
+DB::Status RocksdbDB::DeleteCompKey(const std::string &table, const std::string &key) {
+  rocksdb::WriteOptions wopt;
+  rocksdb::WriteBatch batch;
+  rocksdb::ColumnFamilyHandle *cf = ColumnFamily(table);
+
+  std::string comp_key;
+  for (int i = 0; i < fieldcount_; i++) {
+    comp_key = BuildCompKey(key, field_prefix_ + std::to_string(i));
+    batch.Delete(cf, comp_key);
+  }
+
+  rocksdb::Status s = db_->Write(wopt, &batch);
+  if (!s.ok()) {
+    throw utils::Exception(std::string("RocksDB Write: ") + s.ToString());
+  }
+  return kOK;
+}
+
+DB::Status RocksdbDB::BeginTransaction() {
+  rocksdb::WriteOptions wopt;
+  if (txn_db_) {
+    txn_ = txn_db_->BeginTransaction(wopt, txn_options_, txn_);
+  } else if (otxn_db_) {
+    rocksdb::OptimisticTransactionOptions otxn_options;
+    otxn_options.set_snapshot = txn_options_.set_snapshot;
+    txn_ = otxn_db_->BeginTransaction(wopt, otxn_options, txn_);
+  } else {
+    return kNotImplemented;
+  }
+  in_txn_ = true;
+  return kOK;
+}
+
+DB::Status RocksdbDB::CommitTransaction() {
+  if (!in_txn_) {
+    return kNotImplemented;
+  }
+  in_txn_ = false;
+  rocksdb::Status s = txn_->Commit();
+  if (!s.ok()) {
+    return TxnFailed(s, "Commit");
+  }
+  return kOK;
+}
+
+DB::Status RocksdbDB::AbortTransaction() {
+  if (!in_txn_) {
+    return kNotImplemented;
+  }
+  in_txn_ = false;
+  rocksdb::Status s = txn_->Rollback();
+  if (!s.ok()) {
+    throw utils::Exception(std::string("RocksDB Transaction Rollback: ") + s.ToString());
+  }
+  return kOK;
+}
+
+rocksdb::Status RocksdbDB::TxnGet(rocksdb::ColumnFamilyHandle *cf, const std::string &key, std::string *data,
+                                  bool for_update) {
+  rocksdb::ReadOptions ropt;
+  ropt.snapshot = txn_->GetSnapshot();
+  if (for_update) {
+    return txn_->GetForUpdate(ropt, cf, key, data);
+  }
+  return txn_->Get(ropt, cf, key, data);
+}
+
+DB::Status RocksdbDB::TxnFailed(const rocksdb::Status &s, const char *what) {
+  // conflicts and deadlocks are Busy, a lock wait past the timeout TimedOut,
+  // optimistic validation without enough memtable history TryAgain
+  if (s.IsBusy()) {
+    txn_busy.fetch_add(1, std::memory_order_relaxed);
+  } else if (s.IsTimedOut()) {
+    txn_timed_out.fetch_add(1, std::memory_order_relaxed);
+  } else if (s.IsTryAgain()) {
+    txn_try_again.fetch_add(1, std::memory_order_relaxed);
+  } else if (s.IsExpired()) {
+    txn_expired.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    throw utils::Exception(std::string("RocksDB Transaction ") + what + ": " + s.ToString());
+  }
+  return kError;
+}
+
+DB::Status RocksdbDB::UpdateReadOnly(const std::string &table, const std::string &key,
+                                     std::vector<Field> &values) {
+  return kNotImplemented;
+}
+
+DB::Status RocksdbDB::DeleteReadOnly(const std::string &table, const std::string &key) {
+  return kNotImplemented;
+}
+
 DB *NewRocksdbDB() {
   return new RocksdbDB;
 }
@@ -8,56 +8,124 @@
 #ifndef YCSB_C_ROCKSDB_DB_H_
 #define YCSB_C_ROCKSDB_DB_H_
 
+#include <map>
+#include <memory>
 #include <string>
 #include <mutex>
+#include <unordered_map>
+#include <utility>
 
 #include "core/db.h"
+#include "rocksdb_scan.h"
 #include "utils/properties.h"
+#include "utils/utils.h"
 
 #include <rocksdb/db.h>
 #include <rocksdb/options.h>
+#include <rocksdb/utilities/optimistic_transaction_db.h>
+#include <rocksdb/utilities/transaction_db.h>
 
 namespace ycsbc {
 
 class RocksdbDB : public DB {
  public:
-  RocksdbDB() {}
+  RocksdbDB() : bulkload_(false), bulk_buffer_bytes_(0), status_catchups_(0),
+                status_catchup_micros_(0), secondary_(false), txn_(nullptr), in_txn_(false),
+                txn_get_for_update_(true), snapshot_read_proportion_(0) {}
   ~RocksdbDB() {}
 
   void Init();
 
   void Cleanup();
 
+  bool ReInitBeforeTransaction() override;
+
+  std::string GetStatusMsg() override;
+  void EmitStats(YAML::Node &node) override;
+
   Status Read(const std::string &table, const std::string &key,
               const std::vector<std::string> *fields, std::vector<Field> &result) {
+    PerfSample sample;
     return (this->*(method_read_))(table, key, fields, result);
   }
 
   Status Scan(const std::string &table, const std::string &key, int len,
               const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result) {
+    PerfSample sample;
     return (this->*(method_scan_))(table, key, len, fields, result);
   }
 
   Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
+    PerfSample sample;
     return (this->*(method_update_))(table, key, values);
   }
 
   Status Insert(const std::string &table, const std::string &key, std::vector<Field> &values) {
+    PerfSample sample;
     return (this->*(method_insert_))(table, key, values);
   }
 
   Status Delete(const std::string &table, const std::string &key) {
+    PerfSample sample;
     return (this->*(method_delete_))(table, key);
   }
 
+  Status BeginTransaction() override;
+  Status CommitTransaction() override;
+  Status AbortTransaction() override;
+
  private:
+  ///
+  /// Collects PerfContext and IOStatsContext of one operation, drawn with
+  /// probability rocksdb.perf_sample_rate, into process-wide counters.
+  ///
+  class PerfSample {
+   public:
+    PerfSample() : active_(perf_sample_rate_ > 0 && utils::ThreadLocalRandomDouble() < perf_sample_rate_) {
+      if (active_) {
+        Start();
+      }
+    }
+    ~PerfSample() {
+      if (active_) {
+        Stop();
+      }
+    }
+   private:
+    static void Start();
+    static void Stop();
+    const bool active_;
+  };
+
   enum RocksFormat {
     kSingleRow,
+    kRowMajor,
+    kColumnMajor
   };
   RocksFormat format_;
 
+  class UpdateMerge;
+
   void GetOptions(const utils::Properties &props, rocksdb::Options *opt,
                   std::vector<rocksdb::ColumnFamilyDescriptor> *cf_descs);
+  static rocksdb::ColumnFamilyHandle *ColumnFamily(const std::string &table) {
+    auto it = cf_map_.find(table);
+    return it == cf_map_.end() ? db_->DefaultColumnFamily() : it->second;
+  }
+  // reads of secondary client threads go to the secondary instance
+  rocksdb::DB *Reader() const {
+    return secondary_ ? secondary_db_ : db_;
+  }
+  rocksdb::ColumnFamilyHandle *ReaderColumnFamily(const std::string &table) const {
+    if (!secondary_) {
+      return ColumnFamily(table);
+    }
+    auto it = secondary_cf_map_.find(table);
+    return it == secondary_cf_map_.end() ? secondary_db_->DefaultColumnFamily() : it->second;
+  }
+  static void OpenSecondary(const utils::Properties &props, rocksdb::Options opt, const std::string &db_path,
+                            const std::vector<rocksdb::ColumnFamilyDescriptor> &cf_descs);
+  static void CatchUpWithPrimary(int interval_ms);
   static void SerializeRow(const std::vector<Field> &values, std::string &data);
   static void DeserializeRowFilter(std::vector<Field> &values, const char *p, const char *lim,
                                    const std::vector<std::string> &fields);
@@ -65,6 +133,9 @@ class RocksdbDB : public DB {
                                    const std::vector<std::string> &fields);
   static void DeserializeRow(std::vector<Field> &values, const char *p, const char *lim);
   static void DeserializeRow(std::vector<Field> &values, const std::string &data);
+  std::string BuildCompKey(const std::string &key, const std::string &field_name);
+  static std::string KeyFromCompKey(const rocksdb::Slice &comp_key);
+  static std::string FieldFromCompKey(const rocksdb::Slice &comp_key);
 
   Status ReadSingle(const std::string &table, const std::string &key,
                     const std::vector<std::string> *fields, std::vector<Field> &result);
@@ -78,6 +149,37 @@ class RocksdbDB : public DB {
   Status InsertSingle(const std::string &table, const std::string &key,
                       std::vector<Field> &values);
   Status DeleteSingle(const std::string &table, const std::string &key);
+  Status ReadCompKeyRM(const std::string &table, const std::string &key,
+                       const std::vector<std::string> *fields, std::vector<Field> &result);
+  Status ScanCompKeyRM(const std::string &table, const std::string &key, int len,
+                       const std::vector<std::string> *fields,
+                       std::vector<std::vector<Field>> &result);
+  Status ReadCompKeyCM(const std::string &table, const std::string &key,
+                       const std::vector<std::string> *fields, std::vector<Field> &result);
+  Status ScanCompKeyCM(const std::string &table, const std::string &key, int len,
+                       const std::vector<std::string> *fields,
+                       std::vector<std::vector<Field>> &result);
+  Status MultiGetCompKey(const std::string &table, const std::string &key,
+                         const std::vector<std::string> &fields, std::vector<Field> &result);
+  Status InsertCompKey(const std::string &table, const std::string &key,
+                       std::vector<Field> &values);
+  Status DeleteCompKey(const std::string &table, const std::string &key);
+  Status UpdateReadOnly(const std::string &table, const std::string &key,
+                        std::vector<Field> &values);
+  Status DeleteReadOnly(const std::string &table, const std::string &key);
+  Status InsertBulk(const std::string &table, const std::string &key,
+                    std::vector<Field> &values);
+
+  static void CollectBlobProperties();
+  static void CollectSnapshotProperties();
+  std::shared_ptr<const rocksdb::Snapshot> NextSnapshot();
+
+  rocksdb::Status TxnGet(rocksdb::ColumnFamilyHandle *cf, const std::string &key, std::string *data,
+                         bool for_update);
+  static Status TxnFailed(const rocksdb::Status &s, const char *what);
+
+  void WriteBulkFiles();
+  static void IngestBulkFiles();
 
   Status (RocksdbDB::*method_read_)(const std::string &, const std:: string &,
                                     const std::vector<std::string> *, std::vector<Field> &);
@@ -91,8 +193,42 @@ class RocksdbDB : public DB {
   Status (RocksdbDB::*method_delete_)(const std::string &, const std::string &);
 
   int fieldcount_;
+  std::string field_prefix_;
+  RocksdbScanner scanner_;
+
+  // bulk load: rows buffered per column family, written as sorted SST files
+  bool bulkload_;
+  std::map<rocksdb::ColumnFamilyHandle *, std::vector<std::pair<std::string, std::string>>> bulk_buffer_;
+  size_t bulk_buffer_bytes_;
+  static std::map<rocksdb::ColumnFamilyHandle *, std::vector<std::string>> bulk_files_;
+  static std::mutex bulk_mu_;
+  static bool bulk_loaded_;
+
+  // ticker values at the previous GetStatusMsg()
+  std::vector<uint64_t> status_tickers_;
+  // catch-up counters at the previous GetStatusMsg()
+  uint64_t status_catchups_;
+  uint64_t status_catchup_micros_;
+  static double perf_sample_rate_;
 
   static std::vector<rocksdb::ColumnFamilyHandle *> cf_handles_;
+  static std::unordered_map<std::string, rocksdb::ColumnFamilyHandle *> cf_map_;
+  bool secondary_;
+  static rocksdb::DB *secondary_db_;
+  static std::vector<rocksdb::ColumnFamilyHandle *> secondary_cf_handles_;
+  static std::unordered_map<std::string, rocksdb::ColumnFamilyHandle *> secondary_cf_map_;
+
+  // rocksdb.txn: db_ is one of these, the per-thread transaction is reused
+  static rocksdb::TransactionDB *txn_db_;
+  static rocksdb::OptimisticTransactionDB *otxn_db_;
+  rocksdb::Transaction *txn_;
+  bool in_txn_;
+  rocksdb::TransactionOptions txn_options_;
+  bool txn_get_for_update_;
+
+  // share of reads and scans at a snapshot of the process-wide pool
+  double snapshot_read_proportion_;
+
   static rocksdb::DB *db_;
   static int ref_cnt_;
   static std::mutex mu_;
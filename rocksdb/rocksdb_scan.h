@@ -0,0 +1,159 @@
+//
+//  rocksdb_scan.h
+//  YCSB-cpp
+//
+//  Scan iterators tuned for short range scans, shared by the rocksdb binding
+//  and rocksdb_svr.
+//
+
+#ifndef YCSB_C_ROCKSDB_SCAN_H_
+#define YCSB_C_ROCKSDB_SCAN_H_
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "utils/properties.h"
+#include "utils/utils.h"
+
+#include <rocksdb/db.h>
+#include <rocksdb/iterator.h>
+#include <rocksdb/options.h>
+
+namespace ycsbc {
+
+// keep one iterator per column family and Refresh() it instead of creating
+// a new one for every scan
+const std::string PROP_SCAN_REUSE_ITERATOR = "rocksdb.scan_reuse_iterator";
+const std::string PROP_SCAN_REUSE_ITERATOR_DEFAULT = "false";
+
+const std::string PROP_SCAN_READAHEAD_SIZE = "rocksdb.scan_readahead_size";
+const std::string PROP_SCAN_READAHEAD_SIZE_DEFAULT = "0";
+
+const std::string PROP_SCAN_FILL_CACHE = "rocksdb.scan_fill_cache";
+const std::string PROP_SCAN_FILL_CACHE_DEFAULT = "true";
+
+// bound each scan at key + len, only exact for insertorder=ordered
+const std::string PROP_SCAN_UPPER_BOUND = "rocksdb.scan_upper_bound";
+const std::string PROP_SCAN_UPPER_BOUND_DEFAULT = "false";
+
+const std::string PROP_SCAN_AUTO_PREFIX_MODE = "rocksdb.scan_auto_prefix_mode";
+const std::string PROP_SCAN_AUTO_PREFIX_MODE_DEFAULT = "false";
+
+///
+/// The exclusive upper bound of a scan of len rows from key when keys are a
+/// prefix followed by a zero-padded sequence number, e.g. user00000000000000000042.
+/// Without a number, or when key + len needs more digits, the bound is the
+/// first key past the prefix.
+///
+inline std::string RocksdbScanUpperBound(const std::string &key, int len) {
+  size_t digits = key.size();
+  while (digits > 0 && key[digits - 1] >= '0' && key[digits - 1] <= '9') {
+    digits--;
+  }
+  // the low 19 digits fit in a uint64_t; the padding above them stays
+  const size_t width = std::min<size_t>(key.size() - digits, 19);
+  const size_t start = key.size() - width;
+  if (width > 0) {
+    const std::string num = std::to_string(std::stoull(key.substr(start)) + len);
+    if (num.size() <= width) {
+      return key.substr(0, start).append(width - num.size(), '0').append(num);
+    }
+  }
+  std::string bound = key.substr(0, digits);
+  while (!bound.empty() && static_cast<unsigned char>(bound.back()) == 0xff) {
+    bound.pop_back();
+  }
+  if (bound.empty()) {
+    return std::string(key.size() + 1, '\xff');
+  }
+  bound.back()++;
+  return bound;
+}
+
+///
+/// Positions scan iterators. Each client thread (or server thread) owns one;
+/// it must be cleared before the database is closed.
+///
+class RocksdbScanner {
+ public:
+  RocksdbScanner() : reuse_(false), upper_bound_(false) {}
+
+  ///
+  /// total_order_seek: scans cross prefixes of the prefix extractor.
+  ///
+  void Init(const utils::Properties &props, bool total_order_seek = false) {
+    reuse_ = props.GetProperty(PROP_SCAN_REUSE_ITERATOR, PROP_SCAN_REUSE_ITERATOR_DEFAULT) == "true";
+    upper_bound_ = props.GetProperty(PROP_SCAN_UPPER_BOUND, PROP_SCAN_UPPER_BOUND_DEFAULT) == "true";
+    read_options_.readahead_size = std::stoull(props.GetProperty(PROP_SCAN_READAHEAD_SIZE,
+                                                                 PROP_SCAN_READAHEAD_SIZE_DEFAULT));
+    read_options_.fill_cache = props.GetProperty(PROP_SCAN_FILL_CACHE, PROP_SCAN_FILL_CACHE_DEFAULT) == "true";
+    read_options_.auto_prefix_mode = props.GetProperty(PROP_SCAN_AUTO_PREFIX_MODE,
+                                                       PROP_SCAN_AUTO_PREFIX_MODE_DEFAULT) == "true";
+    // auto_prefix_mode keeps total order and only uses the prefix bloom where that is safe
+    read_options_.total_order_seek = total_order_seek && !read_options_.auto_prefix_mode;
+    // a reused iterator keeps this pointer, the bound is rewritten before each Seek
+    read_options_.iterate_upper_bound = upper_bound_ ? &bound_slice_ : nullptr;
+  }
+
+  ///
+  /// An iterator on cf positioned at key, valid until Done(). A scan at a
+  /// snapshot gets its own iterator: Refresh() would move a kept one to the
+  /// latest state instead.
+  ///
+  rocksdb::Iterator *Seek(rocksdb::DB *db, rocksdb::ColumnFamilyHandle *cf, const std::string &key, int len,
+                          const rocksdb::Snapshot *snapshot = nullptr) {
+    if (upper_bound_) {
+      bound_ = RocksdbScanUpperBound(key, len);
+      bound_slice_ = rocksdb::Slice(bound_);
+    }
+    if (snapshot != nullptr) {
+      rocksdb::ReadOptions read_options = read_options_;
+      read_options.snapshot = snapshot;
+      snapshot_iter_.reset(db->NewIterator(read_options, cf));
+      snapshot_iter_->Seek(key);
+      return snapshot_iter_.get();
+    }
+    std::unique_ptr<rocksdb::Iterator> &iter = iters_[cf];
+    if (!iter) {
+      iter.reset(db->NewIterator(read_options_, cf));
+    } else {
+      rocksdb::Status s = iter->Refresh();
+      if (!s.ok()) {
+        throw utils::Exception(std::string("RocksDB Iterator Refresh: ") + s.ToString());
+      }
+    }
+    iter->Seek(key);
+    return iter.get();
+  }
+
+  ///
+  /// Ends a scan. Without reuse the iterator is released here; a kept one
+  /// pins the memtables and files it last saw until the next Refresh().
+  ///
+  void Done() {
+    snapshot_iter_.reset();
+    if (!reuse_) {
+      iters_.clear();
+    }
+  }
+
+  void Clear() {
+    snapshot_iter_.reset();
+    iters_.clear();
+  }
+
+ private:
+  bool reuse_;
+  bool upper_bound_;
+  rocksdb::ReadOptions read_options_;
+  std::string bound_;
+  rocksdb::Slice bound_slice_;
+  std::unordered_map<rocksdb::ColumnFamilyHandle *, std::unique_ptr<rocksdb::Iterator>> iters_;
+  std::unique_ptr<rocksdb::Iterator> snapshot_iter_;
+};
+
+} // ycsbc
+
+#endif // YCSB_C_ROCKSDB_SCAN_H_
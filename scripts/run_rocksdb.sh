@@ -18,7 +18,7 @@ fi
 source $(dirname "$0")/config.sh
 rocksdb_dir=/data/rocksdb  # rocksdb library directory
 db_dir=/mnt/cephfs/ycsb-rocksdb  # rocksdb database directory
-db_base=/data/db_base_stable  # rocksdb base snapshot directory
+db_base=/mnt/cephfs/ycsb-rocksdb-ckpt  # checkpoint created after each load and restored before each run; same filesystem as db_dir so SST files are hard linked
 output_dir=/data/result/rocksdb  # experiemnt results directory
 local_output_dir=~/result/rocksdb  # local experiemnt results directory
 
@@ -35,7 +35,6 @@ done
 function prepare_run() {
     ssh -o StrictHostKeyChecking=no $user@$server "echo 3G | sudo tee /sys/fs/cgroup/memory/ycsb/memory.limit_in_bytes"
     ssh -o StrictHostKeyChecking=no $user@$server "echo 3 | sudo tee /proc/sys/vm/drop_caches"
-    ssh -o StrictHostKeyChecking=no $user@$server "sudo rm -rf $db_dir/ ; cgexec -g memory:ycsb cp -r $db_base $db_dir"
 }
 
 function prepare_load() {
@@ -66,9 +65,9 @@ function run_rocksdb_server() {
 
     if [ $mode = load ]
     then
-        extra_flag+="-p rocksdb.destroy=true"
+        extra_flag+="-p rocksdb.destroy=true -p rocksdb.checkpoint_dir=$db_base"
     else
-        extra_flag+="-p rocksdb.destroy=false"
+        extra_flag+="-p rocksdb.destroy=false -p rocksdb.checkpoint=restore -p rocksdb.checkpoint_dir=$db_base"
     fi
 
     ssh -o StrictHostKeyChecking=no $user@$server "sudo LD_LIBRARY_PATH=$rocksdb_dir $extra_lib \
@@ -1,5 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "core/db.h"
+#include "utils/properties.h"
+
 const std::string PROP_UDP_PORT_CLI = "sqlite.udp_port_cli";
 const std::string PROP_UDP_PORT_CLI_DEFAULT = "31850";
 
@@ -33,6 +40,40 @@ const std::string PROP_JOURNAL_MODE_DEFAULT = "WAL";
 const std::string PROP_SYNCHRONOUS = "sqlite.synchronous";
 const std::string PROP_SYNCHRONOUS_DEFAULT = "NORMAL";
 
+// writes per BEGIN/COMMIT transaction, 1 commits each one on its own
+const std::string PROP_BATCH = "sqlite.batch";
+const std::string PROP_BATCH_DEFAULT = "1";
+
+// bytes of the database file accessed through mmap, 0 disables it
+const std::string PROP_MMAP_SIZE = "sqlite.mmap_size";
+const std::string PROP_MMAP_SIZE_DEFAULT = "0";
+
+// pages, or KiB if negative
+const std::string PROP_CACHE_SIZE = "sqlite.cache_size";
+const std::string PROP_CACHE_SIZE_DEFAULT = "-2000";
+
+// only applies when the database file is created
+const std::string PROP_PAGE_SIZE = "sqlite.page_size";
+const std::string PROP_PAGE_SIZE_DEFAULT = "4096";
+
+///
+/// Size of the request and response buffers. A scan response of
+/// maxscanlength rows sized by fieldcount, fieldnameprefix and fieldlength must
+/// fit, so the server needs the workload properties too; sqlite.msg_size can
+/// only raise it. The workload keys are spelled out because sqlite_svr is
+/// built without the core workload.
+///
+inline size_t SQLiteMsgSize(const ycsbc::utils::Properties &props) {
+  const size_t field_count = std::stoul(props.GetProperty("fieldcount", "10"));
+  const size_t field_length = std::stoul(props.GetProperty("fieldlength", "100"));
+  const size_t name_length = props.GetProperty("fieldnameprefix", "field").size() +
+                             std::to_string(field_count).size();
+  // | row_len | field_len | field | value_len | value |...
+  const size_t row = sizeof(uint32_t) + field_count * (2 * sizeof(uint32_t) + name_length + field_length);
+  const size_t scan = sizeof(ycsbc::DB::Status) + std::stoul(props.GetProperty("maxscanlength", "1000")) * row;
+  return std::max<size_t>(std::stoull(props.GetProperty(PROP_MSG_SIZE, PROP_MSG_SIZE_DEFAULT)), scan);
+}
+
 const uint8_t SQL_READ_REQ    = 0;
 const uint8_t SQL_UPDATE_REQ  = 1;
 const uint8_t SQL_INSERT_REQ  = 2;
@@ -49,7 +49,7 @@ void SQLiteDB::Init() {
   }
   std::cout << "eRPC client " << (int)rpc_id << " connected to " << server_uri << std::endl;
 
-  const int msg_size = std::stoull(props.GetProperty(PROP_MSG_SIZE, PROP_MSG_SIZE_DEFAULT));
+  const size_t msg_size = SQLiteMsgSize(props);
   req_ = rpc_->alloc_msg_buffer_or_die(msg_size);
   resp_ = rpc_->alloc_msg_buffer_or_die(msg_size);
 }
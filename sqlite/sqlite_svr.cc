@@ -4,11 +4,12 @@
 
 #include <mutex>
 #include <string>
+#include <thread>
 
 #include "common.h"
 #include "core/command_line.h"
 #include "core/db.h"
-#include "core/properties.h"
+#include "utils/properties.h"
 
 #define DEBUG 0
 #define ERR_DEBUG 1
@@ -23,10 +24,17 @@ static bool run = true;
 std::mutex mu_;
 sqlite3 *ServerContext::db_ = nullptr;
 bool ServerContext::setup_ = false;
+sqlite3_stmt *ServerContext::begin_stmt_ = nullptr;
+sqlite3_stmt *ServerContext::commit_stmt_ = nullptr;
+int ServerContext::batch_size_ = 1;
+int ServerContext::batch_writes_ = 0;
+uint64_t ServerContext::batch_commits_ = 0;
+uint64_t ServerContext::batch_failures_ = 0;
 
 using namespace ycsbc;
 
 void server_func(erpc::Nexus *nexus, int thread_id, const utils::Properties *props);
+void commit_batch();
 
 void sigint_handler(int _signum) { run = false; }
 void svr_sm_handler(int, erpc::SmEventType, erpc::SmErrType, void *) {}
@@ -49,6 +57,7 @@ int main(const int argc, const char *argv[]) {
   nexus.register_req_func(SQL_UPDATE_REQ, update_handler);
   nexus.register_req_func(SQL_INSERT_REQ, insert_handler);
   nexus.register_req_func(SQL_DELETE_REQ, delete_handler);
+  nexus.register_req_func(SQL_SCAN_REQ, scan_handler);
 
   const int n_threads = std::stoi(props.GetProperty("threadcount", "1"));
   std::vector<std::thread> server_threads;
@@ -61,6 +70,14 @@ int main(const int argc, const char *argv[]) {
     t.join();
   }
 
+  commit_batch();
+  sqlite3_finalize(ServerContext::begin_stmt_);
+  sqlite3_finalize(ServerContext::commit_stmt_);
+  if (ServerContext::batch_size_ > 1) {
+    std::cout << "batch commits: " << ServerContext::batch_commits_
+              << ", failed batches: " << ServerContext::batch_failures_ << std::endl;
+  }
+
   // comment this to avoid checkpoint WAL to database upon close
   int ret = sqlite3_close(ServerContext::db_);
   if (ret != SQLITE_OK) {
@@ -132,6 +149,85 @@ bool prepareDeleteQuery(ServerContext *ctx) {
   return true;
 }
 
+bool prepareScanQuery(ServerContext *ctx) {
+  sqlite3_stmt *stmt;
+  // the primary key index returns the rows in order, no sort step
+  const std::string query("SELECT " + COLUMN_NAME + " FROM " + TABLE_NAME + " WHERE " + PRIMARY_KEY +
+                          " >= ? ORDER BY " + PRIMARY_KEY + " LIMIT ?;");
+  int ret = sqlite3_prepare_v2(ctx->db_, query.c_str(), query.size() + 1, &stmt, NULL);
+  if (ret != SQLITE_OK) {
+    std::cerr << "Failed to prepare scan query: " << query << ". error: " << sqlite3_errmsg(ctx->db_)
+              << std::endl;
+    sqlite3_finalize(stmt);
+    return false;
+  }
+  ctx->prepared_stmts_[SQL_SCAN_REQ] = stmt;
+  return true;
+}
+
+bool prepareBatchQueries() {
+  // IMMEDIATE takes the write lock up front, a batch never fails halfway on SQLITE_BUSY
+  const std::string begin("BEGIN IMMEDIATE;");
+  const std::string commit("COMMIT;");
+  if (sqlite3_prepare_v2(ServerContext::db_, begin.c_str(), begin.size() + 1, &ServerContext::begin_stmt_,
+                         NULL) != SQLITE_OK ||
+      sqlite3_prepare_v2(ServerContext::db_, commit.c_str(), commit.size() + 1, &ServerContext::commit_stmt_,
+                         NULL) != SQLITE_OK) {
+    std::cerr << "Failed to prepare batch queries, error: " << sqlite3_errmsg(ServerContext::db_) << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// must be called with mu_ held; SQLITE_DONE, or the error after rolling the batch back
+int commit_batch_locked() {
+  if (ServerContext::batch_writes_ == 0) {
+    return SQLITE_DONE;
+  }
+  ServerContext::batch_writes_ = 0;
+  int ret = sqlite3_step(ServerContext::commit_stmt_);
+  sqlite3_reset(ServerContext::commit_stmt_);
+  if (ret == SQLITE_DONE) {
+    ServerContext::batch_commits_++;
+    return ret;
+  }
+  ServerContext::batch_failures_++;
+  std::cerr << "Failed to commit batch, error: " << sqlite3_errstr(ret) << std::endl;
+  sqlite3_exec(ServerContext::db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+  return ret;
+}
+
+void commit_batch() {
+  std::lock_guard<std::mutex> lock(mu_);
+  commit_batch_locked();
+}
+
+// sqlite3_step() of a write, in the open batch when sqlite.batch > 1
+int step_write(sqlite3_stmt *stmt) {
+  if (ServerContext::batch_size_ <= 1) {
+    return sqlite3_step(stmt);
+  }
+  std::lock_guard<std::mutex> lock(mu_);
+  int ret;
+  if (ServerContext::batch_writes_ == 0) {
+    ret = sqlite3_step(ServerContext::begin_stmt_);
+    sqlite3_reset(ServerContext::begin_stmt_);
+    if (ret != SQLITE_DONE) {
+      return ret;
+    }
+  }
+  // a failed statement is undone on its own, the batch stays open
+  ret = sqlite3_step(stmt);
+  if (++ServerContext::batch_writes_ >= ServerContext::batch_size_) {
+    // the write that ends a batch reports whether the batch committed
+    const int commit_ret = commit_batch_locked();
+    if (commit_ret != SQLITE_DONE) {
+      ret = commit_ret;
+    }
+  }
+  return ret;
+}
+
 void read_handler(erpc::ReqHandle *req_handle, void *context) {
   ServerContext *ctx = static_cast<ServerContext *>(context);
   auto *rpc = ctx->rpc_;
@@ -227,7 +323,7 @@ void insert_handler(erpc::ReqHandle *req_handle, void *context) {
     goto insert_resp;
   }
 
-  ret = sqlite3_step(stmt);
+  ret = step_write(stmt);
   rpc->resize_msg_buffer(&resp, sizeof(DB::Status));
   if (ret == SQLITE_DONE) {
     *reinterpret_cast<DB::Status *>(resp.buf_) = DB::Status::kOK;
@@ -286,7 +382,7 @@ void update_handler(erpc::ReqHandle *req_handle, void *context) {
     goto update_resp;
   }
 
-  ret = sqlite3_step(stmt);
+  ret = step_write(stmt);
   rpc->resize_msg_buffer(&resp, sizeof(DB::Status));
   if (ret == SQLITE_DONE) {
     *reinterpret_cast<DB::Status *>(resp.buf_) = DB::Status::kOK;
@@ -333,7 +429,7 @@ void delete_handler(erpc::ReqHandle *req_handle, void *context) {
     goto delete_resp;
   }
 
-  ret = sqlite3_step(stmt);
+  ret = step_write(stmt);
   rpc->resize_msg_buffer(&resp, sizeof(DB::Status));
   if (ret == SQLITE_DONE) {
     *reinterpret_cast<DB::Status *>(resp.buf_) = DB::Status::kOK;
@@ -352,6 +448,78 @@ delete_resp:
   rpc->enqueue_response(req_handle, &resp);
 }
 
+void scan_handler(erpc::ReqHandle *req_handle, void *context) {
+  ServerContext *ctx = static_cast<ServerContext *>(context);
+  auto *rpc = ctx->rpc_;
+  auto *req = req_handle->get_req_msgbuf();
+  auto &resp = ctx->resp_buf_;
+  std::string key = DeserializeKey(reinterpret_cast<const char *>(req->buf_));
+  int len = *reinterpret_cast<const int *>(req->buf_ + sizeof(uint32_t) + key.size());
+  size_t offset = sizeof(DB::Status);
+  DB::Status s = DB::Status::kOK;
+  sqlite3_stmt *stmt;
+  int ret;
+#if DEBUG
+  std::cout << "[SCAN] key: " << key << " len: " << len << std::endl;
+#endif
+
+  if (ctx->prepared_stmts_.find(SQL_SCAN_REQ) == ctx->prepared_stmts_.end()) {
+    if (!prepareScanQuery(ctx)) {
+      rpc->resize_msg_buffer(&resp, sizeof(DB::Status));
+      *reinterpret_cast<DB::Status *>(resp.buf_) = DB::Status::kError;
+      rpc->enqueue_response(req_handle, &resp);
+      return;
+    }
+  }
+  stmt = ctx->prepared_stmts_[SQL_SCAN_REQ];
+  ret = sqlite3_bind_text(stmt, 1, key.data(), key.size(), SQLITE_STATIC);
+  if (ret != SQLITE_OK) {
+    std::cerr << "Failed to bind key to scan query, error: " << sqlite3_errstr(ret) << std::endl;
+    s = DB::Status::kError;
+    goto scan_resp;
+  }
+  ret = sqlite3_bind_int(stmt, 2, len);
+  if (ret != SQLITE_OK) {
+    std::cerr << "Failed to bind limit to scan query, error: " << sqlite3_errstr(ret) << std::endl;
+    s = DB::Status::kError;
+    goto scan_resp;
+  }
+
+  // rows are copied from the statement straight into the response buffer:
+  // | status | value0_len | value0 | value1_len | value1 |...
+  rpc->resize_msg_buffer(&resp, ctx->resp_buf_size_);
+  while ((ret = sqlite3_step(stmt)) == SQLITE_ROW) {
+    const uint8_t *value = sqlite3_column_text(stmt, 0);
+    uint32_t value_size = sqlite3_column_bytes(stmt, 0);
+    if (offset + sizeof(uint32_t) + value_size > ctx->resp_buf_size_) {
+      std::cerr << "Scan of " << len << " rows does not fit in " << ctx->resp_buf_size_
+                << " bytes, start the server with the workload's maxscanlength, fieldcount and fieldlength"
+                << std::endl;
+      s = DB::Status::kError;
+      break;
+    }
+    memcpy(resp.buf_ + offset, &value_size, sizeof(uint32_t));
+    offset += sizeof(uint32_t);
+    memcpy(resp.buf_ + offset, value, value_size);
+    offset += value_size;
+  }
+  if (s == DB::Status::kOK && ret != SQLITE_DONE) {
+#if ERR_DEBUG
+    std::cerr << "Failed to scan, error: " << sqlite3_errstr(ret) << std::endl;
+#endif
+    s = DB::Status::kError;
+  }
+
+scan_resp:
+  ret = sqlite3_reset(stmt);
+  if (ret != SQLITE_OK) {
+    std::cerr << "Can't reset scan query, error: " << sqlite3_errstr(ret) << std::endl;
+  }
+  rpc->resize_msg_buffer(&resp, s == DB::Status::kOK ? offset : sizeof(DB::Status));
+  *reinterpret_cast<DB::Status *>(resp.buf_) = s;
+  rpc->enqueue_response(req_handle, &resp);
+}
+
 void server_func(erpc::Nexus *nexus, int thread_id, const utils::Properties *props) {
   ServerContext c;
 
@@ -381,6 +549,15 @@ void server_func(erpc::Nexus *nexus, int thread_id, const utils::Properties *pro
       }
 
       std::string pragmas;
+      pragmas.append("PRAGMA page_size=")
+          .append(props->GetProperty(PROP_PAGE_SIZE, PROP_PAGE_SIZE_DEFAULT))
+          .append(";");
+      pragmas.append("PRAGMA mmap_size=")
+          .append(props->GetProperty(PROP_MMAP_SIZE, PROP_MMAP_SIZE_DEFAULT))
+          .append(";");
+      pragmas.append("PRAGMA cache_size=")
+          .append(props->GetProperty(PROP_CACHE_SIZE, PROP_CACHE_SIZE_DEFAULT))
+          .append(";");
       pragmas.append("PRAGMA wal_autocheckpoint=")
           .append(props->GetProperty(PROP_WAL_AUTOCHECKPOINT, PROP_WAL_AUTOCHECKPOINT_DEFAULT))
           .append(";");
@@ -408,6 +585,12 @@ void server_func(erpc::Nexus *nexus, int thread_id, const utils::Properties *pro
         sqlite3_close(c.db_);
         throw utils::Exception(std::string("Can't create table, error: ") + err_msg);
       }
+
+      ServerContext::batch_size_ = std::stoi(props->GetProperty(PROP_BATCH, PROP_BATCH_DEFAULT));
+      if (ServerContext::batch_size_ > 1 && !prepareBatchQueries()) {
+        sqlite3_close(c.db_);
+        throw utils::Exception("Can't prepare batch queries");
+      }
     }
 
     ServerContext::setup_ = true;
@@ -415,8 +598,9 @@ void server_func(erpc::Nexus *nexus, int thread_id, const utils::Properties *pro
 
   std::cout << "thread " << thread_id << " start running" << std::endl;
 
-  const int msg_size = std::stoull(props->GetProperty(PROP_MSG_SIZE, PROP_MSG_SIZE_DEFAULT));
+  const size_t msg_size = SQLiteMsgSize(*props);
   c.resp_buf_ = rpc.alloc_msg_buffer_or_die(msg_size);
+  c.resp_buf_size_ = msg_size;
   while (run) {
     rpc.run_event_loop(1000);
   }
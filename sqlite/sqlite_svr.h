@@ -11,6 +11,7 @@ void read_handler(erpc::ReqHandle *req_handle, void *context);
 void insert_handler(erpc::ReqHandle *req_handle, void *context);
 void update_handler(erpc::ReqHandle *req_handle, void *context);
 void delete_handler(erpc::ReqHandle *req_handle, void *context);
+void scan_handler(erpc::ReqHandle *req_handle, void *context);
 
 class ServerContext {
  public:
@@ -22,10 +23,19 @@ class ServerContext {
 
   erpc::Rpc<erpc::CTransport> *rpc_;
   erpc::MsgBuffer resp_buf_;
+  size_t resp_buf_size_;
   static sqlite3 *db_;
   std::unordered_map<uint8_t, sqlite3_stmt *> prepared_stmts_;
   int session_num_;
   static bool setup_;
+  // writes of all server threads are grouped into BEGIN IMMEDIATE ... COMMIT
+  // transactions of batch_size_ statements
+  static sqlite3_stmt *begin_stmt_;
+  static sqlite3_stmt *commit_stmt_;
+  static int batch_size_;
+  static int batch_writes_;
+  static uint64_t batch_commits_;
+  static uint64_t batch_failures_;
   int thread_id_;
 };
 
@@ -1,11 +1,18 @@
 #include "sqlocal_db.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <mutex>
+#include <sstream>
 #include <string>
+#include <thread>
 
 #include "core/db_factory.h"
 
+#include <yaml-cpp/yaml.h>
+
 #define DEBUG 0
 #define ERR_DEBUG 1
 
@@ -28,6 +35,45 @@ const std::string PROP_JOURNAL_MODE_DEFAULT = "WAL";
 
 const std::string PROP_SYNCHRONOUS = "sqlocal.synchronous";
 const std::string PROP_SYNCHRONOUS_DEFAULT = "NORMAL";
+
+// one connection per client thread opened with SQLITE_OPEN_NOMUTEX, needs locking_mode=NORMAL
+const std::string PROP_PER_THREAD_CONN = "sqlocal.per_thread_conn";
+const std::string PROP_PER_THREAD_CONN_DEFAULT = "false";
+
+const std::string PROP_SHARED_CACHE = "sqlocal.shared_cache";
+const std::string PROP_SHARED_CACHE_DEFAULT = "false";
+
+// how long a connection waits for a lock held by another one
+const std::string PROP_BUSY_TIMEOUT_MS = "sqlocal.busy_timeout_ms";
+const std::string PROP_BUSY_TIMEOUT_MS_DEFAULT = "1000";
+
+// retries of a statement that still got SQLITE_BUSY or SQLITE_LOCKED
+const std::string PROP_BUSY_RETRIES = "sqlocal.busy_retries";
+const std::string PROP_BUSY_RETRIES_DEFAULT = "3";
+
+// writes per BEGIN/COMMIT transaction, 1 commits each one on its own
+const std::string PROP_BATCH = "sqlocal.batch";
+const std::string PROP_BATCH_DEFAULT = "1";
+
+// bytes of the database file accessed through mmap, 0 disables it
+const std::string PROP_MMAP_SIZE = "sqlocal.mmap_size";
+const std::string PROP_MMAP_SIZE_DEFAULT = "0";
+
+// pages per connection, or KiB if negative
+const std::string PROP_CACHE_SIZE = "sqlocal.cache_size";
+const std::string PROP_CACHE_SIZE_DEFAULT = "-2000";
+
+// only applies when the database file is created
+const std::string PROP_PAGE_SIZE = "sqlocal.page_size";
+const std::string PROP_PAGE_SIZE_DEFAULT = "4096";
+
+bool per_thread_conn = false;
+std::atomic<uint64_t> batch_commits{0};
+std::atomic<uint64_t> batch_failures{0};
+std::atomic<uint64_t> busy_retry_count{0};
+std::atomic<uint64_t> busy_failure_count{0};
+uint64_t status_retries = 0;
+uint64_t status_failures = 0;
 };  // namespace
 
 namespace ycsbc {
@@ -36,6 +82,7 @@ using namespace std;
 
 mutex lk;
 sqlite3 *SQLocalDB::db_ = nullptr;
+SQLocalDB::WriteBatch SQLocalDB::shared_batch_;
 int SQLocalDB::ref_cnt_ = 0;
 
 void SQLocalDB::Init() {
@@ -43,9 +90,18 @@ void SQLocalDB::Init() {
   char *err_msg;
   const utils::Properties &props = *props_;
 
+  const bool per_thread = props.GetProperty(PROP_PER_THREAD_CONN, PROP_PER_THREAD_CONN_DEFAULT) == "true";
+  const int busy_timeout = stoi(props.GetProperty(PROP_BUSY_TIMEOUT_MS, PROP_BUSY_TIMEOUT_MS_DEFAULT));
+  busy_retries_ = stoi(props.GetProperty(PROP_BUSY_RETRIES, PROP_BUSY_RETRIES_DEFAULT));
+  batch_size_ = stoi(props.GetProperty(PROP_BATCH, PROP_BATCH_DEFAULT));
+  if (per_thread && props.GetProperty(PROP_LOCKING_MODE, PROP_LOCKING_MODE_DEFAULT) != "NORMAL") {
+    throw utils::Exception(PROP_PER_THREAD_CONN + " needs " + PROP_LOCKING_MODE + "=NORMAL");
+  }
+
   ref_cnt_++;
   if (db_ == nullptr) {
     int ret;
+    per_thread_conn = per_thread;
 
     ret = sqlite3_open(props.GetProperty(PROP_NAME, PROP_NAME_DEFAULT).c_str(), &db_);
     if (ret != SQLITE_OK) {
@@ -61,6 +117,15 @@ void SQLocalDB::Init() {
     }
 
     string pragmas;
+    pragmas.append("PRAGMA page_size=")
+        .append(props.GetProperty(PROP_PAGE_SIZE, PROP_PAGE_SIZE_DEFAULT))
+        .append(";");
+    pragmas.append("PRAGMA mmap_size=")
+        .append(props.GetProperty(PROP_MMAP_SIZE, PROP_MMAP_SIZE_DEFAULT))
+        .append(";");
+    pragmas.append("PRAGMA cache_size=")
+        .append(props.GetProperty(PROP_CACHE_SIZE, PROP_CACHE_SIZE_DEFAULT))
+        .append(";");
     pragmas.append("PRAGMA wal_autocheckpoint=")
         .append(props.GetProperty(PROP_WAL_AUTOCHECKPOINT, PROP_WAL_AUTOCHECKPOINT_DEFAULT))
         .append(";");
@@ -88,6 +153,58 @@ void SQLocalDB::Init() {
       sqlite3_close(db_);
       throw utils::Exception(std::string("Can't create table, error: ") + err_msg);
     }
+    sqlite3_busy_timeout(db_, busy_timeout);
+    if (!per_thread && batch_size_ > 1 && !PrepareBatch(db_, &shared_batch_)) {
+      sqlite3_close(db_);
+      throw utils::Exception(std::string("Can't prepare batch statements, error: ") + sqlite3_errmsg(db_));
+    }
+  }
+
+  conn_ = db_;
+  batch_ = &shared_batch_;
+  if (per_thread) {
+    // NOMUTEX: the connection is only used by this thread, SQLite need not serialize it
+    int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX;
+    if (props.GetProperty(PROP_SHARED_CACHE, PROP_SHARED_CACHE_DEFAULT) == "true") {
+      flags |= SQLITE_OPEN_SHAREDCACHE;
+    }
+    int ret = sqlite3_open_v2(props.GetProperty(PROP_NAME, PROP_NAME_DEFAULT).c_str(), &conn_, flags, nullptr);
+    if (ret != SQLITE_OK) {
+      const std::string msg = sqlite3_errmsg(conn_);
+      sqlite3_close(conn_);
+      throw utils::Exception("SQLite Open: " + msg);
+    }
+    sqlite3_busy_timeout(conn_, busy_timeout);
+
+    // journal_mode=WAL is kept in the file, these are set per connection
+    string pragmas;
+    pragmas.append("PRAGMA mmap_size=")
+        .append(props.GetProperty(PROP_MMAP_SIZE, PROP_MMAP_SIZE_DEFAULT))
+        .append(";");
+    pragmas.append("PRAGMA cache_size=")
+        .append(props.GetProperty(PROP_CACHE_SIZE, PROP_CACHE_SIZE_DEFAULT))
+        .append(";");
+    pragmas.append("PRAGMA wal_autocheckpoint=")
+        .append(props.GetProperty(PROP_WAL_AUTOCHECKPOINT, PROP_WAL_AUTOCHECKPOINT_DEFAULT))
+        .append(";");
+    pragmas.append("PRAGMA synchronous=")
+        .append(props.GetProperty(PROP_SYNCHRONOUS, PROP_SYNCHRONOUS_DEFAULT))
+        .append(";");
+    ret = sqlite3_exec(conn_, pragmas.c_str(), nullptr, nullptr, &err_msg);
+    if (ret != SQLITE_OK) {
+      const std::string msg = err_msg;
+      sqlite3_free(err_msg);
+      sqlite3_close(conn_);
+      throw utils::Exception("Can't set pragmas, error: " + msg);
+    }
+
+    own_batch_.reset(new WriteBatch);
+    batch_ = own_batch_.get();
+    if (batch_size_ > 1 && !PrepareBatch(conn_, batch_)) {
+      const std::string msg = sqlite3_errmsg(conn_);
+      sqlite3_close(conn_);
+      throw utils::Exception("Can't prepare batch statements, error: " + msg);
+    }
   }
 }
 
@@ -96,17 +213,149 @@ void SQLocalDB::Cleanup() {
   for (auto &st : prepared_stmts_) {
     sqlite3_finalize(st.second);
   }
+  prepared_stmts_.clear();
+  if (conn_ != db_) {
+    CommitBatch(batch_);
+    FinalizeBatch(batch_);
+    own_batch_.reset();
+    ret = sqlite3_close(conn_);
+    if (ret != SQLITE_OK) {
+      throw utils::Exception(std::string("Failed to close SQLite: ") + sqlite3_errmsg(conn_));
+    }
+  }
+  conn_ = nullptr;
 
   {
     lock_guard<mutex> guard(lk);
     if (--ref_cnt_) {
       return;
     }
+    CommitBatch(&shared_batch_);
+    FinalizeBatch(&shared_batch_);
     ret = sqlite3_close(db_);
     if (ret != SQLITE_OK) {
       throw utils::Exception(std::string("Failed to close SQLite: ") + sqlite3_errmsg(db_));
     }
+    db_ = nullptr;
+  }
+}
+
+bool SQLocalDB::ReInitBeforeTransaction() {
+  // the load phase ends with Cleanup() so its last batches are committed
+  return stoi(props_->GetProperty(PROP_BATCH, PROP_BATCH_DEFAULT)) > 1;
+}
+
+bool SQLocalDB::PrepareBatch(sqlite3 *conn, WriteBatch *batch) {
+  // IMMEDIATE takes the write lock up front, a batch never fails halfway on SQLITE_BUSY
+  const std::string begin("BEGIN IMMEDIATE;");
+  const std::string commit("COMMIT;");
+  if (sqlite3_prepare_v2(conn, begin.c_str(), begin.size() + 1, &batch->begin, NULL) != SQLITE_OK ||
+      sqlite3_prepare_v2(conn, commit.c_str(), commit.size() + 1, &batch->commit, NULL) != SQLITE_OK) {
+    FinalizeBatch(batch);
+    return false;
+  }
+  return true;
+}
+
+void SQLocalDB::FinalizeBatch(WriteBatch *batch) {
+  sqlite3_finalize(batch->begin);
+  sqlite3_finalize(batch->commit);
+  batch->begin = nullptr;
+  batch->commit = nullptr;
+}
+
+int SQLocalDB::StepWrite(sqlite3_stmt *stmt) {
+  if (batch_size_ <= 1) {
+    return Step(stmt);
+  }
+  // a shared connection has one transaction for all client threads
+  lock_guard<mutex> guard(batch_->mu);
+  int ret;
+  if (batch_->writes == 0) {
+    ret = Step(batch_->begin);
+    sqlite3_reset(batch_->begin);
+    if (ret != SQLITE_DONE) {
+#if ERR_DEBUG
+      std::cerr << "Failed to begin batch, error: " << sqlite3_errstr(ret) << std::endl;
+#endif
+      return ret;
+    }
+  }
+  ret = Step(stmt);
+  if (++batch_->writes >= batch_size_) {
+    // the earlier writes of a rolled back batch already returned; they are counted in batch_failures
+    const int commit_ret = CommitBatch(batch_);
+    if (commit_ret != SQLITE_DONE) {
+      ret = commit_ret;
+    }
+  }
+  return ret;
+}
+
+int SQLocalDB::CommitBatch(WriteBatch *batch) {
+  if (batch->writes == 0) {
+    return SQLITE_DONE;
+  }
+  batch->writes = 0;
+  int ret = Step(batch->commit);
+  sqlite3_reset(batch->commit);
+  if (ret == SQLITE_DONE) {
+    batch_commits.fetch_add(1, std::memory_order_relaxed);
+    return ret;
+  }
+  batch_failures.fetch_add(1, std::memory_order_relaxed);
+  std::cerr << "Failed to commit batch, error: " << sqlite3_errstr(ret) << std::endl;
+  sqlite3_exec(sqlite3_db_handle(batch->commit), "ROLLBACK;", nullptr, nullptr, nullptr);
+  return ret;
+}
+
+int SQLocalDB::Step(sqlite3_stmt *stmt) {
+  int ret = sqlite3_step(stmt);
+  for (int i = 0; (ret == SQLITE_BUSY || ret == SQLITE_LOCKED) && i < busy_retries_; i++) {
+    busy_retry_count.fetch_add(1, std::memory_order_relaxed);
+    // SQLITE_LOCKED (a shared cache table lock) does not wait in the busy handler
+    if (ret == SQLITE_LOCKED) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100 << std::min(i, 10)));
+    }
+    sqlite3_reset(stmt);
+    ret = sqlite3_step(stmt);
+  }
+  if (ret == SQLITE_BUSY || ret == SQLITE_LOCKED) {
+    busy_failure_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  return ret;
+}
+
+std::string SQLocalDB::GetStatusMsg() {
+  if (!per_thread_conn) {
+    return "";
   }
+  const uint64_t retries = busy_retry_count.load(std::memory_order_relaxed);
+  const uint64_t failures = busy_failure_count.load(std::memory_order_relaxed);
+  std::ostringstream msg_stream;
+  msg_stream << "[SQLITE: Period BusyRetries=" << retries - status_retries
+             << " BusyFailures=" << failures - status_failures << ']';
+  status_retries = retries;
+  status_failures = failures;
+  return msg_stream.str();
+}
+
+void SQLocalDB::EmitStats(YAML::Node &node) {
+  const uint64_t retries = busy_retry_count.exchange(0);
+  const uint64_t failures = busy_failure_count.exchange(0);
+  const uint64_t commits = batch_commits.exchange(0);
+  const uint64_t commit_failures = batch_failures.exchange(0);
+  status_retries = 0;
+  status_failures = 0;
+  if (!per_thread_conn && retries == 0 && failures == 0 && commits == 0 && commit_failures == 0) {
+    return;
+  }
+  YAML::Node sqlite_node;
+  sqlite_node["busy_retries"] = retries;
+  sqlite_node["busy_failures"] = failures;
+  sqlite_node["batch_commits"] = commits;
+  sqlite_node["batch_failures"] = commit_failures;
+  node["sqlite"] = sqlite_node;
 }
 
 DB::Status SQLocalDB::Read(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
@@ -128,7 +377,7 @@ DB::Status SQLocalDB::Read(const std::string &table, const std::string &key, con
     goto read_ret;
   }
 
-  ret = sqlite3_step(stmt);
+  ret = Step(stmt);
   if (ret == SQLITE_ROW) {
     const char *value = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
     int value_size = sqlite3_column_bytes(stmt, 0);
@@ -151,6 +400,53 @@ read_ret:
   return s;
 }
 
+DB::Status SQLocalDB::Scan(const std::string &table, const std::string &key, int len,
+                           const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result) {
+  sqlite3_stmt *stmt;
+  int ret;
+  Status s = Status::kOK;
+
+  if (prepared_stmts_.find(SQL_SCAN_REQ) == prepared_stmts_.end()) {
+    if (!prepareScanQuery()) {
+      return Status::kError;
+    }
+  }
+  stmt = prepared_stmts_[SQL_SCAN_REQ];
+  ret = sqlite3_bind_text(stmt, 1, key.data(), key.size(), SQLITE_STATIC);
+  if (ret != SQLITE_OK) {
+    std::cerr << "Failed to bind key to scan query, error: " << sqlite3_errstr(ret) << std::endl;
+    s = Status::kError;
+    goto scan_ret;
+  }
+  ret = sqlite3_bind_int(stmt, 2, len);
+  if (ret != SQLITE_OK) {
+    std::cerr << "Failed to bind limit to scan query, error: " << sqlite3_errstr(ret) << std::endl;
+    s = Status::kError;
+    goto scan_ret;
+  }
+
+  result.reserve(len);
+  while ((ret = Step(stmt)) == SQLITE_ROW) {
+    const char *value = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+    int value_size = sqlite3_column_bytes(stmt, 0);
+    result.emplace_back();
+    DeserializeRow(result.back(), value, value + value_size);
+  }
+  if (ret != SQLITE_DONE) {
+#if ERR_DEBUG
+    std::cerr << "Failed to scan, error: " << sqlite3_errstr(ret) << std::endl;
+#endif
+    s = Status::kError;
+  }
+
+scan_ret:
+  ret = sqlite3_reset(stmt);
+  if (ret != SQLITE_OK) {
+    std::cerr << "Can't reset scan query, error: " << sqlite3_errstr(ret) << std::endl;
+  }
+  return s;
+}
+
 DB::Status SQLocalDB::Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
   sqlite3_stmt *stmt;
   int ret;
@@ -178,7 +474,7 @@ DB::Status SQLocalDB::Update(const std::string &table, const std::string &key, s
     goto update_ret;
   }
 
-  ret = sqlite3_step(stmt);
+  ret = StepWrite(stmt);
   if (ret == SQLITE_DONE) {
     s = DB::Status::kOK;
   } else {
@@ -223,7 +519,7 @@ DB::Status SQLocalDB::Insert(const std::string &table, const std::string &key, s
     goto insert_ret;
   }
 
-  ret = sqlite3_step(stmt);
+  ret = StepWrite(stmt);
   if (ret == SQLITE_DONE) {
     s = DB::Status::kOK;
   } else {
@@ -260,7 +556,7 @@ DB::Status SQLocalDB::Delete(const std::string &table, const std::string &key) {
     goto delete_ret;
   }
 
-  ret = sqlite3_step(stmt);
+  ret = StepWrite(stmt);
   if (ret == SQLITE_DONE) {
     s = DB::Status::kOK;
   } else {
@@ -281,9 +577,9 @@ delete_ret:
 bool SQLocalDB::prepareReadQuery() {
   sqlite3_stmt *stmt;
   const std::string query("SELECT " + COLUMN_NAME + " FROM " + TABLE_NAME + " WHERE " + PRIMARY_KEY + " = ?;");
-  int ret = sqlite3_prepare_v2(db_, query.c_str(), query.size() + 1, &stmt, NULL);
+  int ret = sqlite3_prepare_v2(conn_, query.c_str(), query.size() + 1, &stmt, NULL);
   if (ret != SQLITE_OK) {
-    std::cerr << "Failed to prepare read query: " << query << ". error: " << sqlite3_errmsg(db_) << std::endl;
+    std::cerr << "Failed to prepare read query: " << query << ". error: " << sqlite3_errmsg(conn_) << std::endl;
     sqlite3_finalize(stmt);
     return false;
   }
@@ -294,9 +590,9 @@ bool SQLocalDB::prepareReadQuery() {
 bool SQLocalDB::prepareInsertQuery() {
   sqlite3_stmt *stmt;
   const std::string query("INSERT INTO " + TABLE_NAME + " (" + PRIMARY_KEY + "," + COLUMN_NAME + ") VALUES (?, ?);");
-  int ret = sqlite3_prepare_v2(db_, query.c_str(), query.size() + 1, &stmt, NULL);
+  int ret = sqlite3_prepare_v2(conn_, query.c_str(), query.size() + 1, &stmt, NULL);
   if (ret != SQLITE_OK) {
-    std::cerr << "Failed to prepare insert query: " << query << ". error: " << sqlite3_errmsg(db_) << std::endl;
+    std::cerr << "Failed to prepare insert query: " << query << ". error: " << sqlite3_errmsg(conn_) << std::endl;
     sqlite3_finalize(stmt);
     return false;
   }
@@ -307,9 +603,9 @@ bool SQLocalDB::prepareInsertQuery() {
 bool SQLocalDB::prepareUpdateQuery() {
   sqlite3_stmt *stmt;
   const std::string query("UPDATE " + TABLE_NAME + " SET " + COLUMN_NAME + " = ? WHERE " + PRIMARY_KEY + " = ?;");
-  int ret = sqlite3_prepare_v2(db_, query.c_str(), query.size() + 1, &stmt, NULL);
+  int ret = sqlite3_prepare_v2(conn_, query.c_str(), query.size() + 1, &stmt, NULL);
   if (ret != SQLITE_OK) {
-    std::cerr << "Failed to prepare update query: " << query << ". error: " << sqlite3_errmsg(db_) << std::endl;
+    std::cerr << "Failed to prepare update query: " << query << ". error: " << sqlite3_errmsg(conn_) << std::endl;
     sqlite3_finalize(stmt);
     return false;
   }
@@ -320,9 +616,9 @@ bool SQLocalDB::prepareUpdateQuery() {
 bool SQLocalDB::prepareDeleteQuery() {
   sqlite3_stmt *stmt;
   const std::string query("DELETE FROM " + TABLE_NAME + " WHERE " + PRIMARY_KEY + " = ?;");
-  int ret = sqlite3_prepare_v2(db_, query.c_str(), query.size() + 1, &stmt, NULL);
+  int ret = sqlite3_prepare_v2(conn_, query.c_str(), query.size() + 1, &stmt, NULL);
   if (ret != SQLITE_OK) {
-    std::cerr << "Failed to prepare delete query: " << query << ". error: " << sqlite3_errmsg(db_) << std::endl;
+    std::cerr << "Failed to prepare delete query: " << query << ". error: " << sqlite3_errmsg(conn_) << std::endl;
     sqlite3_finalize(stmt);
     return false;
   }
@@ -330,6 +626,21 @@ bool SQLocalDB::prepareDeleteQuery() {
   return true;
 }
 
+bool SQLocalDB::prepareScanQuery() {
+  sqlite3_stmt *stmt;
+  // the primary key index returns the rows in order, no sort step
+  const std::string query("SELECT " + COLUMN_NAME + " FROM " + TABLE_NAME + " WHERE " + PRIMARY_KEY +
+                          " >= ? ORDER BY " + PRIMARY_KEY + " LIMIT ?;");
+  int ret = sqlite3_prepare_v2(conn_, query.c_str(), query.size() + 1, &stmt, NULL);
+  if (ret != SQLITE_OK) {
+    std::cerr << "Failed to prepare scan query: " << query << ". error: " << sqlite3_errmsg(conn_) << std::endl;
+    sqlite3_finalize(stmt);
+    return false;
+  }
+  prepared_stmts_[SQL_SCAN_REQ] = stmt;
+  return true;
+}
+
 void SQLocalDB::SerializeRow(const std::vector<Field> &values, std::string &data) {
   for (const Field &field : values) {
     uint32_t len = field.first.size();
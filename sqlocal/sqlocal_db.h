@@ -3,6 +3,8 @@
 
 #include <sqlite3.h>
 
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #include "core/db.h"
@@ -22,21 +24,57 @@ class SQLocalDB : public DB {
   void Init() override;
   void Cleanup() override;
 
+  bool ReInitBeforeTransaction() override;
+
   Status Read(const std::string &table, const std::string &key, const std::vector<std::string> *fields,
               std::vector<Field> &result) override;
   Status Scan(const std::string &table, const std::string &key, int record_count,
-              const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result) {
-    return Status::kNotImplemented;
-  }
+              const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result) override;
   Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) override;
   Status Insert(const std::string &table, const std::string &key, std::vector<Field> &values) override;
   Status Delete(const std::string &table, const std::string &key) override;
 
+  std::string GetStatusMsg() override;
+  void EmitStats(YAML::Node &node) override;
+
  protected:
   bool prepareReadQuery();
   bool prepareInsertQuery();
   bool prepareUpdateQuery();
   bool prepareDeleteQuery();
+  bool prepareScanQuery();
+
+  ///
+  /// sqlite3_step() that retries a statement failing with SQLITE_BUSY or
+  /// SQLITE_LOCKED up to busy_retries_ times.
+  ///
+  int Step(sqlite3_stmt *stmt);
+
+  ///
+  /// Writes of one connection grouped into BEGIN IMMEDIATE ... COMMIT
+  /// transactions of sqlocal.batch statements.
+  ///
+  struct WriteBatch {
+    std::mutex mu;
+    sqlite3_stmt *begin = nullptr;
+    sqlite3_stmt *commit = nullptr;
+    // statements in the open transaction, 0 when none is open
+    int writes = 0;
+  };
+  static bool PrepareBatch(sqlite3 *conn, WriteBatch *batch);
+  static void FinalizeBatch(WriteBatch *batch);
+  ///
+  /// Step() of a write statement, in the connection's open batch when
+  /// batching is on. A failed statement is undone on its own; the write
+  /// that ends a batch fails if the batch does not commit.
+  ///
+  int StepWrite(sqlite3_stmt *stmt);
+  ///
+  /// Commits the open batch, rolled back if that fails.
+  ///
+  /// @return SQLITE_DONE on success or if no batch is open, the error otherwise.
+  ///
+  int CommitBatch(WriteBatch *batch);
 
  protected:
   static void SerializeRow(const std::vector<Field> &values, std::string &data);
@@ -44,8 +82,18 @@ class SQLocalDB : public DB {
   static void DeserializeRow(std::vector<Field> &values, const std::string &data);
 
  protected:
+  // creates the table and, without per-thread connections, runs every operation
   static sqlite3 *db_;
   static int ref_cnt_;
+  // db_ or the connection of this client thread
+  sqlite3 *conn_ = nullptr;
+  int busy_retries_ = 0;
+
+  static WriteBatch shared_batch_;
+  std::unique_ptr<WriteBatch> own_batch_;
+  // the batch of conn_
+  WriteBatch *batch_ = nullptr;
+  int batch_size_ = 1;
   std::unordered_map<uint8_t, sqlite3_stmt *> prepared_stmts_;
 };
 
@@ -0,0 +1,199 @@
+//
+//  ycsb_gen.cc
+//  YCSB-cpp
+//
+//  Standalone generator for pre-built workload files. Draws the operation
+//  stream of any CoreWorkload property set and writes, per thread, either
+//  binary traces for TraceReplayWorkload (gen.format=binary) or run.w.N
+//  insert files for PureInsertWorkload (gen.format=text).
+//
+//  ./ycsb_gen -load -run -threads 16 -P workloads/workloada -p gen.dir=/data/trace
+//
+
+#include <exception>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/command_line.h"
+#include "core/trace_file.h"
+#include "core/tracepeek.h"
+#include "utils/properties.h"
+#include "utils/timer.h"
+#include "utils/utils.h"
+
+namespace {
+  const std::string PROP_FORMAT = "gen.format";
+  const std::string PROP_FORMAT_DEFAULT = "binary";
+
+  const std::string PROP_DIR = "gen.dir";
+  const std::string PROP_DIR_DEFAULT = ".";
+
+  const std::string PROP_BUFFER_SIZE = "gen.buffer_size";
+  const std::string PROP_BUFFER_SIZE_DEFAULT = "67108864";
+
+  // load keys: "range" gives each thread a contiguous slice of the key space,
+  // "shared" draws from one counter like ycsb does
+  const std::string PROP_SHARD = "gen.shard";
+  const std::string PROP_SHARD_DEFAULT = "range";
+
+  // text format only, matches PureInsertWorkload's run.w.(i*threadcount+thread+1)
+  const std::string PROP_FILES_PER_THREAD = "gen.files_per_thread";
+  const std::string PROP_FILES_PER_THREAD_DEFAULT = "1";
+
+  const size_t kTextKeyLength = 24;  // user + 20 digits, see InsertThreadState
+} // anonymous
+
+using namespace ycsbc;
+
+struct GenConfig {
+  bool binary;
+  bool range_shard;
+  std::string dir;
+  size_t buffer_size;
+  int files_per_thread;
+};
+
+uint64_t GenBinary(TracePeek *wl, const GenConfig &cfg, int thread_id, uint64_t num_ops, uint64_t key_start,
+                   bool is_loading) {
+  TraceWriter writer(TraceFileName(cfg.dir, is_loading, thread_id), cfg.buffer_size);
+  writer.AppendHeader();
+  TraceRecord rec;
+  for (uint64_t i = 0; i < num_ops; ++i) {
+    if (!is_loading) {
+      wl->NextTransactionRecord(rec);
+    } else if (cfg.range_shard) {
+      wl->NextInsertRecord(rec, key_start + i);
+    } else {
+      wl->NextInsertRecord(rec);
+    }
+    writer.Append(rec);
+  }
+  writer.Close();
+  return num_ops;
+}
+
+uint64_t GenText(TracePeek *wl, const GenConfig &cfg, int thread_id, int thread_count, uint64_t num_ops,
+                 uint64_t key_start) {
+  std::string line;
+  TraceRecord rec;
+  uint64_t done = 0;
+  for (int f = 0; f < cfg.files_per_thread; ++f) {
+    uint64_t file_ops = num_ops / cfg.files_per_thread + (f < static_cast<int>(num_ops % cfg.files_per_thread));
+    TraceWriter writer(cfg.dir + "/run.w." + std::to_string(f * thread_count + thread_id + 1), cfg.buffer_size);
+    for (uint64_t i = 0; i < file_ops; ++i, ++done) {
+      if (cfg.range_shard) {
+        wl->NextInsertRecord(rec, key_start + done);
+      } else {
+        wl->NextInsertRecord(rec);
+      }
+      line.assign("I ").append(wl->BuildKeyName(rec.key_num)).append("\n");
+      if (line.size() != kTextKeyLength + 3) {
+        throw utils::Exception("text format needs " + std::to_string(kTextKeyLength) + "-byte keys, got " +
+                               line.substr(2, line.size() - 3));
+      }
+      writer.Append(line.data(), line.size());
+    }
+    writer.Close();
+  }
+  return done;
+}
+
+uint64_t GenThread(TracePeek *wl, const GenConfig *cfg, int thread_id, int thread_count, uint64_t num_ops,
+                   uint64_t key_start, bool is_loading) {
+  try {
+    if (cfg->binary) {
+      return GenBinary(wl, *cfg, thread_id, num_ops, key_start, is_loading);
+    }
+    return GenText(wl, *cfg, thread_id, thread_count, num_ops, key_start);
+  } catch (const std::exception &e) {
+    std::cerr << "Caught exception: " << e.what() << std::endl;
+    exit(1);
+  }
+}
+
+void GenPhase(TracePeek *wl, const GenConfig &cfg, const utils::Properties &props, int num_threads,
+              bool is_loading) {
+  const uint64_t total_ops = std::stoull(props[is_loading ? CoreWorkload::RECORD_COUNT_PROPERTY
+                                                          : CoreWorkload::OPERATION_COUNT_PROPERTY]);
+  uint64_t key_start = std::stoull(props.GetProperty(CoreWorkload::INSERT_START_PROPERTY,
+                                                     CoreWorkload::INSERT_START_DEFAULT));
+
+  utils::Timer<double> timer;
+  timer.Start();
+  std::vector<std::future<uint64_t>> gen_threads;
+  for (int i = 0; i < num_threads; ++i) {
+    uint64_t thread_ops = total_ops / num_threads;
+    if (static_cast<uint64_t>(i) < total_ops % num_threads) {
+      thread_ops++;
+    }
+    gen_threads.emplace_back(std::async(std::launch::async, GenThread, wl, &cfg, i, num_threads, thread_ops,
+                                        key_start, is_loading));
+    key_start += thread_ops;
+  }
+  uint64_t sum = 0;
+  for (auto &n : gen_threads) {
+    sum += n.get();
+  }
+  double runtime = timer.End();
+
+  const char *phase = is_loading ? "Load" : "Run";
+  std::cout << phase << " generated(ops): " << sum << std::endl;
+  std::cout << phase << " runtime(sec): " << runtime << std::endl;
+  std::cout << phase << " throughput(ops/sec): " << sum / runtime << std::endl;
+}
+
+int main(const int argc, const char *argv[]) {
+  utils::Properties props;
+  ParseCommandLine(argc, argv, props);
+
+  const bool do_load = (props.GetProperty("doload", "false") == "true");
+  const bool do_transaction = (props.GetProperty("dotransaction", "false") == "true");
+  if (!do_load && !do_transaction) {
+    std::cerr << "No operation to do" << std::endl;
+    exit(1);
+  }
+  const int num_threads = std::stoi(props.GetProperty("threadcount", "1"));
+
+  GenConfig cfg;
+  const std::string format = props.GetProperty(PROP_FORMAT, PROP_FORMAT_DEFAULT);
+  if (format != "binary" && format != "text") {
+    std::cerr << "Unknown " << PROP_FORMAT << ": " << format << std::endl;
+    exit(1);
+  }
+  cfg.binary = (format == "binary");
+  const std::string shard = props.GetProperty(PROP_SHARD, PROP_SHARD_DEFAULT);
+  if (shard != "range" && shard != "shared") {
+    std::cerr << "Unknown " << PROP_SHARD << ": " << shard << std::endl;
+    exit(1);
+  }
+  cfg.range_shard = (shard == "range");
+  cfg.dir = props.GetProperty(PROP_DIR, PROP_DIR_DEFAULT);
+  cfg.buffer_size = std::stoull(props.GetProperty(PROP_BUFFER_SIZE, PROP_BUFFER_SIZE_DEFAULT));
+  cfg.files_per_thread = std::stoi(props.GetProperty(PROP_FILES_PER_THREAD, PROP_FILES_PER_THREAD_DEFAULT));
+  if (cfg.files_per_thread < 1) {
+    std::cerr << PROP_FILES_PER_THREAD << " must be at least 1" << std::endl;
+    exit(1);
+  }
+  if (!cfg.binary && do_transaction) {
+    std::cerr << "text format carries only the insert stream, use -load" << std::endl;
+    exit(1);
+  }
+
+  TracePeek wl;
+  try {
+    wl.Init(props);
+  } catch (const std::exception &e) {
+    std::cerr << "Caught exception: " << e.what() << std::endl;
+    exit(1);
+  }
+
+  if (do_load) {
+    GenPhase(&wl, cfg, props, num_threads, true);
+  }
+  if (do_transaction) {
+    GenPhase(&wl, cfg, props, num_threads, false);
+  }
+  return 0;
+}
@@ -6,7 +6,11 @@
 #include <cstring>
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
 #include <set>
+#include <filesystem>
+#include <sstream>
 #include <sys/stat.h>
 #if defined(_MSC_VER)
 #include "direct.h"
@@ -15,10 +19,13 @@
 
 #include "core/core_workload.h"
 #include "core/db_factory.h"
+#include "core/multi_table_workload.h"
 #include "utils/utils.h"
 
 #include "wiredtiger_db.h"
 
+#include <yaml-cpp/yaml.h>
+
 #define WT_PREFIX "wiredtiger"
 #define STR(x) #x
 
@@ -33,9 +40,14 @@ namespace {
   const std::string PROP_HOME = WT_PREFIX ".home";
   const std::string PROP_HOME_DEFAULT = "";
 
+  // single: a row per key, row: a key per field, column: a column group per field
   const std::string PROP_FORMAT = WT_PREFIX ".format";
   const std::string PROP_FORMAT_DEFAULT = "single";
 
+  // btree or lsm
+  const std::string PROP_TABLE_TYPE = WT_PREFIX ".table_type";
+  const std::string PROP_TABLE_TYPE_DEFAULT = "btree";
+
   const std::string PROP_CACHE_SIZE = WT_PREFIX ".cache_size";
   const std::string PROP_CACHE_SIZE_DEFAULT = "100MB";
 
@@ -45,6 +57,56 @@ namespace {
   const std::string PROP_IN_MEMORY = WT_PREFIX ".in_memory";
   const std::string PROP_IN_MEMORY_DEFAULT = "false";
 
+  const std::string PROP_EVICTION_THREADS_MIN = WT_PREFIX ".eviction.threads_min";
+  const std::string PROP_EVICTION_THREADS_MIN_DEFAULT = "";
+
+  const std::string PROP_EVICTION_THREADS_MAX = WT_PREFIX ".eviction.threads_max";
+  const std::string PROP_EVICTION_THREADS_MAX_DEFAULT = "";
+
+  const std::string PROP_EVICTION_TARGET = WT_PREFIX ".eviction.target";
+  const std::string PROP_EVICTION_TARGET_DEFAULT = "";
+
+  const std::string PROP_EVICTION_TRIGGER = WT_PREFIX ".eviction.trigger";
+  const std::string PROP_EVICTION_TRIGGER_DEFAULT = "";
+
+  const std::string PROP_EVICTION_DIRTY_TARGET = WT_PREFIX ".eviction.dirty_target";
+  const std::string PROP_EVICTION_DIRTY_TARGET_DEFAULT = "";
+
+  const std::string PROP_EVICTION_DIRTY_TRIGGER = WT_PREFIX ".eviction.dirty_trigger";
+  const std::string PROP_EVICTION_DIRTY_TRIGGER_DEFAULT = "";
+
+  const std::string PROP_LOG_ENABLED = WT_PREFIX ".log.enabled";
+  const std::string PROP_LOG_ENABLED_DEFAULT = "false";
+
+  const std::string PROP_LOG_FILE_MAX = WT_PREFIX ".log.file_max";
+  const std::string PROP_LOG_FILE_MAX_DEFAULT = "";
+
+  const std::string PROP_LOG_COMPRESSOR = WT_PREFIX ".log.compressor";
+  const std::string PROP_LOG_COMPRESSOR_DEFAULT = "";
+
+  // periodic checkpoints, every wait seconds or log_size bytes of log
+  const std::string PROP_CHECKPOINT_WAIT = WT_PREFIX ".checkpoint.wait";
+  const std::string PROP_CHECKPOINT_WAIT_DEFAULT = "";
+
+  const std::string PROP_CHECKPOINT_LOG_SIZE = WT_PREFIX ".checkpoint.log_size";
+  const std::string PROP_CHECKPOINT_LOG_SIZE_DEFAULT = "";
+
+  // read-uncommitted, read-committed or snapshot
+  const std::string PROP_ISOLATION = WT_PREFIX ".isolation";
+  const std::string PROP_ISOLATION_DEFAULT = "snapshot";
+
+  // operations per transaction, 0 runs each one on its own (autocommit)
+  const std::string PROP_TXN_BATCH = WT_PREFIX ".txn_batch";
+  const std::string PROP_TXN_BATCH_DEFAULT = "0";
+
+  // on, off or empty for the connection default
+  const std::string PROP_TXN_SYNC = WT_PREFIX ".txn_sync";
+  const std::string PROP_TXN_SYNC_DEFAULT = "";
+
+  // none, fast or all; fast leaves the more expensive counters at zero
+  const std::string PROP_STATISTICS = WT_PREFIX ".statistics";
+  const std::string PROP_STATISTICS_DEFAULT = "none";
+
   const std::string PROP_LSM_MGR_MERGE = WT_PREFIX ".lsm_mgr.merge";
   const std::string PROP_LSM_MGR_MERGE_DEFAULT = "true";
 
@@ -80,11 +142,83 @@ namespace {
 
   const std::string PROP_BLK_MGR_BTREE_LEAF_PAGE_MAX = WT_PREFIX ".blk_mgr.btree.leaf_page_max";
   const std::string PROP_BLK_MGR_BTREE_LEAF_PAGE_MAX_DEFAULT = "32KB";
+
+  const std::string PROP_CHECKPOINT_DIR = WT_PREFIX ".checkpoint_dir";
+  const std::string PROP_CHECKPOINT_DIR_DEFAULT = "";
+
+  // auto: create after a load, restore before a run without load
+  const std::string PROP_CHECKPOINT = WT_PREFIX ".checkpoint";
+  const std::string PROP_CHECKPOINT_DEFAULT = "auto";
+
+  static std::string home_dir;
+  static std::string checkpoint_dir;
+  static bool checkpoint_create = false;
+  static bool reopen = false;
+
+  std::atomic<uint64_t> txn_commits{0};
+  std::atomic<uint64_t> txn_rollbacks{0};
+
+  struct WTStat {
+    int key;
+    const char *name;
+    const char *status_name;
+    // a current level rather than a counter
+    bool gauge;
+  };
+
+  // the keys differ between WiredTiger releases, missing ones are skipped
+  const std::vector<WTStat> kStats = {
+#ifdef WT_STAT_CONN_CACHE_BYTES_INUSE
+    {WT_STAT_CONN_CACHE_BYTES_INUSE, "cache_bytes_inuse", "CacheBytes", true},
+#endif
+#ifdef WT_STAT_CONN_CACHE_BYTES_DIRTY
+    {WT_STAT_CONN_CACHE_BYTES_DIRTY, "cache_bytes_dirty", "DirtyBytes", true},
+#endif
+#ifdef WT_STAT_CONN_CACHE_READ
+    {WT_STAT_CONN_CACHE_READ, "pages_read", "PagesRead", false},
+#endif
+#ifdef WT_STAT_CONN_CACHE_EVICTION_APP
+    {WT_STAT_CONN_CACHE_EVICTION_APP, "pages_evicted_by_app", "AppEvicted", false},
+#endif
+#ifdef WT_STAT_CONN_CACHE_EVICTION_DIRTY
+    {WT_STAT_CONN_CACHE_EVICTION_DIRTY, "dirty_pages_evicted", "DirtyEvicted", false},
+#endif
+#ifdef WT_STAT_CONN_APPLICATION_EVICT_TIME
+    {WT_STAT_CONN_APPLICATION_EVICT_TIME, "app_evict_time_us", "AppEvictUs", false},
+#endif
+#ifdef WT_STAT_CONN_APPLICATION_CACHE_TIME
+    {WT_STAT_CONN_APPLICATION_CACHE_TIME, "app_cache_wait_us", "AppCacheWaitUs", false},
+#endif
+#ifdef WT_STAT_CONN_TXN_CHECKPOINT
+    {WT_STAT_CONN_TXN_CHECKPOINT, "checkpoints", "Checkpoints", false},
+#endif
+#ifdef WT_STAT_CONN_TXN_CHECKPOINT_TIME_TOTAL
+    {WT_STAT_CONN_TXN_CHECKPOINT_TIME_TOTAL, "checkpoint_time_ms", "CheckpointMs", false},
+#endif
+#ifdef WT_STAT_CONN_TXN_CHECKPOINT_TIME_RECENT
+    {WT_STAT_CONN_TXN_CHECKPOINT_TIME_RECENT, "last_checkpoint_time_ms", "LastCheckpointMs", true},
+#endif
+#ifdef WT_STAT_CONN_LOG_SYNC
+    {WT_STAT_CONN_LOG_SYNC, "log_syncs", "LogSyncs", false},
+#endif
+#ifdef WT_STAT_CONN_LOG_SYNC_DURATION
+    {WT_STAT_CONN_LOG_SYNC_DURATION, "log_sync_time_us", "LogSyncUs", false},
+#endif
+  };
+
+  static bool statistics = false;
+  // the last sample, the counters at the previous status line, the counters
+  // when the phase started and the gauges' maximum
+  static std::vector<int64_t> stat_values;
+  static std::vector<int64_t> stat_status;
+  static std::vector<int64_t> stat_base;
+  static std::vector<int64_t> stat_max;
 }
 
 namespace ycsbc {
 
 WT_CONNECTION* WTDB::conn_ = nullptr;
+WT_SESSION* WTDB::stats_session_ = nullptr;
 int WTDB::ref_cnt_ = 0;
 std::mutex WTDB::mu_;
 
@@ -95,21 +229,48 @@ void WTDB::Init(){
   const std::string &format = props.GetProperty(PROP_FORMAT, PROP_FORMAT_DEFAULT);
   fieldcount_ = std::stoi(props.GetProperty(CoreWorkload::FIELD_COUNT_PROPERTY,
                                             CoreWorkload::FIELD_COUNT_DEFAULT));
+  field_prefix_ = props.GetProperty(CoreWorkload::FIELD_NAME_PREFIX,
+                                    CoreWorkload::FIELD_NAME_PREFIX_DEFAULT);
 
   if(format=="single"){
+    format_ = kSingleRow;
     method_read_ = &WTDB::ReadSingleEntry;
     method_scan_ = &WTDB::ScanSingleEntry;
     method_update_ = &WTDB::UpdateSingleEntry;
     method_insert_ = &WTDB::InsertSingleEntry;
     method_delete_ = &WTDB::DeleteSingleEntry;
+  } else if(format=="row"){
+    format_ = kRowMajor;
+    method_read_ = &WTDB::ReadCompKey;
+    method_scan_ = &WTDB::ScanCompKey;
+    method_update_ = &WTDB::InsertCompKey;
+    method_insert_ = &WTDB::InsertCompKey;
+    method_delete_ = &WTDB::DeleteCompKey;
+  } else if(format=="column"){
+    format_ = kColumnGroup;
+    method_read_ = &WTDB::ReadColumnGroup;
+    method_scan_ = &WTDB::ScanColumnGroup;
+    method_update_ = &WTDB::UpdateColumnGroup;
+    method_insert_ = &WTDB::InsertColumnGroup;
+    method_delete_ = &WTDB::DeleteSingleEntry;
+    for (unsigned i = 0; i < fieldcount_; i++) {
+      columns_.push_back(field_prefix_ + std::to_string(i));
+    }
+    value_format_.assign(fieldcount_, 'u');
   } else {
-    throw utils::Exception("single ONLY");
+    throw utils::Exception("unknown format");
   }
 
+  txn_batch_ = std::stoi(props.GetProperty(PROP_TXN_BATCH, PROP_TXN_BATCH_DEFAULT));
+  const std::string &txn_sync = props.GetProperty(PROP_TXN_SYNC, PROP_TXN_SYNC_DEFAULT);
+  commit_config_ = txn_sync.empty() ? "" : "sync=" + txn_sync;
+  // the isolation applies to autocommit operations and transactions alike
+  const std::string session_config = "isolation=" + props.GetProperty(PROP_ISOLATION, PROP_ISOLATION_DEFAULT);
+
   ref_cnt_++;
   if(conn_){
-    error_check(conn_->open_session(conn_, NULL, NULL, &session_));
-    error_check(session_->open_cursor(session_, "table:ycsbc", NULL, "overwrite=true", &cursor_));
+    error_check(conn_->open_session(conn_, NULL, session_config.c_str(), &session_));
+    OpenCursors(props);
     return;
   }
 
@@ -124,6 +285,36 @@ void WTDB::Init(){
     if (ret && errno != EEXIST) {
         throw utils::Exception(std::string("Init mkdir: ") + strerror(errno));
     }
+    home_dir = home;
+
+    // 1.1 Restore a checkpoint; the files are updated in place, so they are copied
+    const bool do_load = props.GetProperty("doload", "false") == "true";
+    const std::string &checkpoint = props.GetProperty(PROP_CHECKPOINT, PROP_CHECKPOINT_DEFAULT);
+    checkpoint_dir = props.GetProperty(PROP_CHECKPOINT_DIR, PROP_CHECKPOINT_DIR_DEFAULT);
+    checkpoint_create = !reopen && !checkpoint_dir.empty() &&
+                        (checkpoint == "create" || (checkpoint == "auto" && do_load));
+    if (!reopen && !checkpoint_dir.empty() && (checkpoint == "restore" || (checkpoint == "auto" && !do_load))) {
+      namespace fs = std::filesystem;
+      std::error_code ec;
+      // a backup cursor hands out WiredTiger.backup, wiredtiger_open rebuilds the metadata from it
+      if (!fs::exists(fs::path(checkpoint_dir) / "WiredTiger.backup", ec)) {
+        throw utils::Exception("Init restore: no checkpoint in " + checkpoint_dir);
+      }
+      for (const auto &entry : fs::directory_iterator(home, ec)) {
+        fs::remove_all(entry.path(), ec);
+      }
+      // the backup cursor lists a flat set of files
+      for (const auto &entry : fs::directory_iterator(checkpoint_dir, ec)) {
+        fs::copy_file(entry.path(), fs::path(home) / entry.path().filename(), fs::copy_options::overwrite_existing, ec);
+        if (ec) {
+          break;
+        }
+      }
+      if (ec) {
+        throw utils::Exception("Init restore " + checkpoint_dir + ": " + ec.message());
+      }
+    }
+    reopen = true;
     
     // 2. Setup db config
     std::string db_config("create,");
@@ -142,7 +333,52 @@ void WTDB::Init(){
       if(!lsm_merge.empty())        lsm_config += "merge=" + lsm_merge + ",";
       if(!lsm_max_workers.empty())  lsm_config += "worker_thread_max=" + lsm_max_workers;
       
-      if(!lsm_config.empty()) db_config += "lsm_manager=(" + lsm_config + ")";
+      if(!lsm_config.empty()) db_config += "lsm_manager=(" + lsm_config + "),";
+    }
+    { // 2.3 Eviction
+      std::string eviction_config;
+      const std::string &threads_min = props.GetProperty(PROP_EVICTION_THREADS_MIN, PROP_EVICTION_THREADS_MIN_DEFAULT);
+      const std::string &threads_max = props.GetProperty(PROP_EVICTION_THREADS_MAX, PROP_EVICTION_THREADS_MAX_DEFAULT);
+      const std::string &target = props.GetProperty(PROP_EVICTION_TARGET, PROP_EVICTION_TARGET_DEFAULT);
+      const std::string &trigger = props.GetProperty(PROP_EVICTION_TRIGGER, PROP_EVICTION_TRIGGER_DEFAULT);
+      const std::string &dirty_target = props.GetProperty(PROP_EVICTION_DIRTY_TARGET, PROP_EVICTION_DIRTY_TARGET_DEFAULT);
+      const std::string &dirty_trigger = props.GetProperty(PROP_EVICTION_DIRTY_TRIGGER, PROP_EVICTION_DIRTY_TRIGGER_DEFAULT);
+      if(!threads_min.empty())  eviction_config += "threads_min=" + threads_min + ",";
+      if(!threads_max.empty())  eviction_config += "threads_max=" + threads_max;
+
+      if(!eviction_config.empty()) db_config += "eviction=(" + eviction_config + "),";
+      if(!target.empty())         db_config += "eviction_target=" + target + ",";
+      if(!trigger.empty())        db_config += "eviction_trigger=" + trigger + ",";
+      if(!dirty_target.empty())   db_config += "eviction_dirty_target=" + dirty_target + ",";
+      if(!dirty_trigger.empty())  db_config += "eviction_dirty_trigger=" + dirty_trigger + ",";
+    }
+    { // 2.4 Log, needed for durable commits and txn_sync
+      std::string log_config;
+      const std::string &enabled = props.GetProperty(PROP_LOG_ENABLED, PROP_LOG_ENABLED_DEFAULT);
+      const std::string &file_max = props.GetProperty(PROP_LOG_FILE_MAX, PROP_LOG_FILE_MAX_DEFAULT);
+      const std::string &compressor = props.GetProperty(PROP_LOG_COMPRESSOR, PROP_LOG_COMPRESSOR_DEFAULT);
+      if(!enabled.empty())    log_config += "enabled=" + enabled + ",";
+      if(!file_max.empty())   log_config += "file_max=" + file_max + ",";
+      if(!compressor.empty()) log_config += "compressor=" + compressor;
+
+      if(!log_config.empty()) db_config += "log=(" + log_config + "),";
+    }
+    { // 2.5 Periodic checkpoints
+      std::string checkpoint_config;
+      const std::string &wait = props.GetProperty(PROP_CHECKPOINT_WAIT, PROP_CHECKPOINT_WAIT_DEFAULT);
+      const std::string &log_size = props.GetProperty(PROP_CHECKPOINT_LOG_SIZE, PROP_CHECKPOINT_LOG_SIZE_DEFAULT);
+      if(!wait.empty())     checkpoint_config += "wait=" + wait + ",";
+      if(!log_size.empty()) checkpoint_config += "log_size=" + log_size;
+
+      if(!checkpoint_config.empty()) db_config += "checkpoint=(" + checkpoint_config + "),";
+    }
+    { // 2.6 Statistics
+      const std::string &stats = props.GetProperty(PROP_STATISTICS, PROP_STATISTICS_DEFAULT);
+      if(stats != "none" && stats != "fast" && stats != "all"){
+        throw utils::Exception("unknown statistics level");
+      }
+      statistics = stats != "none";
+      if(statistics) db_config += "statistics=(" + stats + "),";
     }
     // db_config += ",block_cache=(enabled=true,hashsize=10K,size=300MB,system_ram=300MB,type=DRAM)";
     std::cout<<"db config: "<<db_config<<std::endl;
@@ -150,12 +386,18 @@ void WTDB::Init(){
   }
 
   // Open session (per thread)
-  error_check(conn_->open_session(conn_, NULL, NULL, &session_));
+  error_check(conn_->open_session(conn_, NULL, session_config.c_str(), &session_));
 
   // Create table (once)
   { // 1. Setup block manager
-    std::string table_config("key_format=u,value_format=u,");
+    std::string table_config;
     { // 1.1 General
+      const std::string &type = props.GetProperty(PROP_TABLE_TYPE, PROP_TABLE_TYPE_DEFAULT);
+      if(type != "btree" && type != "lsm"){
+        throw utils::Exception("unknown table type");
+      }
+      // "type" names the data source, its default "file" is a B-tree
+      if(type == "lsm") table_config += "type=lsm,";
       const std::string &alloc_size = props.GetProperty(PROP_BLK_MGR_ALLOCATION_SIZE, PROP_BLK_MGR_ALLOCATION_SIZE_DEFAULT);
       const std::string &compressor = props.GetProperty(PROP_BLK_MGR_COMPRESSOR, PROP_BLK_MGR_COMPRESSOR_DEFAULT);
       if(!alloc_size.empty()) table_config += "allocation_size=" + alloc_size + ",";
@@ -187,91 +429,376 @@ void WTDB::Init(){
       if(!leaf_page_max.empty())      table_config += "leaf_page_max=" + leaf_page_max;
     }
     std::cout<<"table config: "<<table_config<<std::endl;
-    error_check(session_->create(session_, "table:ycsbc", table_config.c_str()));
+    CreateTable("ycsbc", table_config);
+    for (const std::string &table : MultiTableWorkload::TableNames(props)) {
+      CreateTable(table, table_config);
+    }
   }
 
-  // Open cursor (per thread)
-  error_check(session_->open_cursor(session_, "table:ycsbc", NULL, "overwrite=true", &cursor_));
+  // Open cursors (per thread)
+  OpenCursors(props);
+}
+
+void WTDB::CreateTable(const std::string &name, const std::string &storage_config) {
+  if (format_ != kColumnGroup) {
+    error_check(session_->create(session_, ("table:" + name).c_str(),
+                                 ("key_format=u,value_format=u," + storage_config).c_str()));
+    return;
+  }
+  // the storage settings go to the column groups, each one is a file (or LSM tree)
+  std::string columns = "ycsb_key", colgroups;
+  for (const std::string &column : columns_) {
+    columns += "," + column;
+    colgroups += (colgroups.empty() ? "" : ",") + column;
+  }
+  const std::string config = "key_format=u,value_format=" + value_format_ +
+                             ",columns=(" + columns + "),colgroups=(" + colgroups + ")";
+  error_check(session_->create(session_, ("table:" + name).c_str(), config.c_str()));
+  for (const std::string &column : columns_) {
+    error_check(session_->create(session_, ("colgroup:" + name + ":" + column).c_str(),
+                                 ("columns=(" + column + ")," + storage_config).c_str()));
+  }
+}
+
+void WTDB::OpenCursors(const utils::Properties &props) {
+  // column format packs the values itself, a raw cursor takes them as one item
+  const char *config = format_ == kColumnGroup ? "overwrite=true,raw" : "overwrite=true";
+  error_check(session_->open_cursor(session_, "table:ycsbc", NULL, config, &cursor_));
+  for (const std::string &table : MultiTableWorkload::TableNames(props)) {
+    WT_CURSOR *cursor;
+    error_check(session_->open_cursor(session_, ("table:" + table).c_str(), NULL, config, &cursor));
+    cursors_[table] = cursor;
+  }
+}
+
+WT_CURSOR *WTDB::ProjectionCursor(const std::string &table, const std::vector<std::string> &fields) {
+  std::string uri = "table:" + (cursors_.count(table) ? table : std::string("ycsbc")) + "(";
+  for (size_t i = 0; i < fields.size(); i++) {
+    uri += (i ? "," : "") + fields[i];
+  }
+  uri += ")";
+  WT_CURSOR *&cursor = projections_[uri];
+  if (cursor == nullptr) {
+    error_check(session_->open_cursor(session_, uri.c_str(), NULL, "raw", &cursor));
+  }
+  return cursor;
 }
 
 void WTDB::Cleanup(){
   const std::lock_guard<std::mutex> lock(mu_);
+  if (in_txn_ && !explicit_txn_) {
+    Commit();
+  }
+  for (const auto &table : cursors_) {
+    table.second->close(table.second);
+  }
+  cursors_.clear();
+  for (const auto &projection : projections_) {
+    projection.second->close(projection.second);
+  }
+  projections_.clear();
   cursor_->close(cursor_);
   error_check(session_->close(session_, NULL));
   if (--ref_cnt_) {
     return;
   }
+  if (checkpoint_create) {
+    CreateCheckpoint();
+    checkpoint_create = false;
+  }
+  // the counters go with the connection, keep them for the phase summary
+  if (statistics) {
+    SampleStats();
+    error_check(stats_session_->close(stats_session_, NULL));
+    stats_session_ = nullptr;
+  }
   error_check(conn_->close(conn_, NULL));
+  conn_ = nullptr;
+}
+
+bool WTDB::ReInitBeforeTransaction() {
+  // the checkpoint is taken by the last Cleanup() of the load phase
+  const std::string &checkpoint = props_->GetProperty(PROP_CHECKPOINT, PROP_CHECKPOINT_DEFAULT);
+  return props_->GetProperty(PROP_CHECKPOINT_DIR, PROP_CHECKPOINT_DIR_DEFAULT) != "" &&
+         (checkpoint == "auto" || checkpoint == "create");
+}
+
+void WTDB::CreateCheckpoint() {
+  // copy the files listed by a backup cursor, which pins a consistent checkpoint
+  std::error_code ec;
+  std::filesystem::remove_all(checkpoint_dir, ec);
+  std::filesystem::create_directories(checkpoint_dir, ec);
+  if (ec) {
+    throw utils::Exception("Cleanup checkpoint " + checkpoint_dir + ": " + ec.message());
+  }
+  WT_SESSION *session;
+  WT_CURSOR *backup;
+  error_check(conn_->open_session(conn_, NULL, NULL, &session));
+  error_check(session->checkpoint(session, NULL));
+  error_check(session->open_cursor(session, "backup:", NULL, NULL, &backup));
+  int ret;
+  while ((ret = backup->next(backup)) == 0) {
+    const char *filename;
+    error_check(backup->get_key(backup, &filename));
+    std::filesystem::copy_file(home_dir + "/" + filename, checkpoint_dir + "/" + filename,
+                               std::filesystem::copy_options::overwrite_existing, ec);
+    if (ec) {
+      throw utils::Exception("Cleanup checkpoint " + std::string(filename) + ": " + ec.message());
+    }
+  }
+  if (ret != WT_NOTFOUND) {
+    throw utils::Exception(WT_PREFIX " backup cursor error");
+  }
+  error_check(backup->close(backup));
+  error_check(session->close(session, NULL));
+}
+
+DB::Status WTDB::Failed(int ret, const char *op) {
+  if (ret == WT_ROLLBACK) {
+    txn_rollbacks.fetch_add(1, std::memory_order_relaxed);
+    return kError;
+  }
+  throw utils::Exception(std::string(WT_PREFIX " ") + op + ": " + wiredtiger_strerror(ret));
+}
+
+void WTDB::BatchBegin() {
+  if (txn_batch_ > 0 && !in_txn_) {
+    error_check(session_->begin_transaction(session_, NULL));
+    in_txn_ = true;
+    batch_ops_ = 0;
+  }
+}
+
+DB::Status WTDB::BatchEnd(Status s) {
+  if (!in_txn_ || explicit_txn_) {
+    return s;
+  }
+  if (s == kError) {
+    // a conflict aborts the whole batch, the earlier operations in it are lost
+    error_check(session_->rollback_transaction(session_, NULL));
+    in_txn_ = false;
+    return s;
+  }
+  if (++batch_ops_ >= txn_batch_ && !Commit()) {
+    return kError;
+  }
+  return s;
+}
+
+bool WTDB::Commit() {
+  int ret = session_->commit_transaction(session_, commit_config_.c_str());
+  in_txn_ = false;
+  explicit_txn_ = false;
+  if (ret == 0) {
+    txn_commits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  // a failed commit has rolled the transaction back
+  Failed(ret, "commit_transaction");
+  return false;
+}
+
+DB::Status WTDB::BeginTransaction() {
+  if (in_txn_) {
+    // an open batch is committed first, the transaction has its own
+    Commit();
+  }
+  error_check(session_->begin_transaction(session_, NULL));
+  in_txn_ = true;
+  explicit_txn_ = true;
+  return kOK;
+}
+
+DB::Status WTDB::CommitTransaction() {
+  return Commit() ? kOK : kError;
+}
+
+DB::Status WTDB::AbortTransaction() {
+  error_check(session_->rollback_transaction(session_, NULL));
+  in_txn_ = false;
+  explicit_txn_ = false;
+  return kOK;
+}
+
+void WTDB::SampleStats() {
+  // a private session, the status thread and the last Cleanup() take mu_
+  if (stats_session_ == nullptr) {
+    error_check(conn_->open_session(conn_, NULL, NULL, &stats_session_));
+  }
+  WT_CURSOR *cursor;
+  error_check(stats_session_->open_cursor(stats_session_, "statistics:", NULL, NULL, &cursor));
+  stat_values.resize(kStats.size());
+  stat_max.resize(kStats.size(), 0);
+  for (size_t i = 0; i < kStats.size(); i++) {
+    const char *desc, *pvalue;
+    int64_t value;
+    cursor->set_key(cursor, kStats[i].key);
+    error_check(cursor->search(cursor));
+    error_check(cursor->get_value(cursor, &desc, &pvalue, &value));
+    stat_values[i] = value;
+    if (kStats[i].gauge) {
+      stat_max[i] = std::max(stat_max[i], value);
+    }
+  }
+  error_check(cursor->close(cursor));
+}
+
+std::string WTDB::GetStatusMsg() {
+  const std::lock_guard<std::mutex> lock(mu_);
+  if (!statistics || conn_ == nullptr) {
+    return "";
+  }
+  SampleStats();
+  if (stat_status.size() != stat_values.size()) {
+    stat_status.assign(stat_values.size(), 0);
+  }
+  std::ostringstream msg_stream;
+  msg_stream << "[WIREDTIGER:";
+  for (size_t i = 0; i < kStats.size(); i++) {
+    if (kStats[i].gauge) {
+      msg_stream << ' ' << kStats[i].status_name << '=' << stat_values[i];
+    }
+  }
+  msg_stream << " Period";
+  for (size_t i = 0; i < kStats.size(); i++) {
+    if (!kStats[i].gauge) {
+      // counters restart from zero when the connection is reopened
+      const int64_t prev = stat_status[i];
+      msg_stream << ' ' << kStats[i].status_name << '='
+                 << (stat_values[i] >= prev ? stat_values[i] - prev : stat_values[i]);
+    }
+  }
+  msg_stream << ']';
+  stat_status = stat_values;
+  return msg_stream.str();
+}
+
+void WTDB::EmitStats(YAML::Node &node) {
+  YAML::Node wt_node;
+  const uint64_t commits = txn_commits.exchange(0);
+  const uint64_t rollbacks = txn_rollbacks.exchange(0);
+  if (commits > 0 || rollbacks > 0) {
+    wt_node["txn_commits"] = commits;
+    wt_node["txn_rollbacks"] = rollbacks;
+  }
+  {
+    const std::lock_guard<std::mutex> lock(mu_);
+    if (statistics && conn_ != nullptr) {
+      SampleStats();
+    }
+    if (!stat_values.empty()) {
+      if (stat_base.size() != stat_values.size()) {
+        stat_base.assign(stat_values.size(), 0);
+      }
+      YAML::Node stats_node;
+      for (size_t i = 0; i < kStats.size(); i++) {
+        if (kStats[i].gauge) {
+          stats_node[kStats[i].name] = stat_values[i];
+          stats_node[std::string(kStats[i].name) + "_max"] = stat_max[i];
+        } else {
+          // what this phase added, the counters restart from zero on a reopen
+          const int64_t base = stat_base[i];
+          stats_node[kStats[i].name] = stat_values[i] >= base ? stat_values[i] - base : stat_values[i];
+        }
+      }
+      wt_node["statistics"] = stats_node;
+      // a connection kept open carries its counters into the next phase
+      if (conn_ != nullptr) {
+        stat_base = stat_values;
+        stat_status = stat_values;
+      } else {
+        stat_base.clear();
+        stat_status.clear();
+      }
+      stat_values.clear();
+      stat_max.clear();
+    }
+  }
+  if (wt_node.size() > 0) {
+    node["wiredtiger"] = wt_node;
+  }
 }
 
 DB::Status WTDB::ReadSingleEntry(const std::string &table, const std::string &key,
                                       const std::vector<std::string> *fields,
                                       std::vector<Field> &result) {
+  WT_CURSOR *cursor = Cursor(table);
   WT_ITEM k = {key.data(), key.size()};
   WT_ITEM v;
   int ret;
-  cursor_->set_key(cursor_, &k);
-  ret = cursor_->search(cursor_);
+  cursor->set_key(cursor, &k);
+  ret = cursor->search(cursor);
   if(ret==WT_NOTFOUND){
     return kNotFound;
   } else if(ret != 0) {
-    throw utils::Exception(WT_PREFIX " search error");
+    return Failed(ret, "search");
   }
-  error_check(cursor_->get_value(cursor_, &v));
+  error_check(cursor->get_value(cursor, &v));
   if (fields != nullptr) {
     DeserializeRowFilter(&result, (const char*)v.data, v.size, *fields);
   } else {
     DeserializeRow(&result, (const char*)v.data, v.size);
   }
+  // a positioned cursor pins its snapshot and keeps old versions from eviction
+  error_check(cursor->reset(cursor));
   return kOK;
 }
 
 DB::Status WTDB::ScanSingleEntry(const std::string &table, const std::string &key, int len,
                                       const std::vector<std::string> *fields,
                                       std::vector<std::vector<Field>> &result) {
+  WT_CURSOR *cursor = Cursor(table);
   WT_ITEM k = {key.data(), key.size()};
   WT_ITEM v;
-  int ret = 0, exact;
+  int ret, exact;
 
-  cursor_->set_key(cursor_, &k);
-  error_check(cursor_->search_near(cursor_, &exact));
-  if (exact < 0) {
-    ret = cursor_->next(cursor_);
+  cursor->set_key(cursor, &k);
+  ret = cursor->search_near(cursor, &exact);
+  if (ret == 0 && exact < 0) {
+    ret = cursor->next(cursor);
   }
   for(int i=0; !ret && i<len; ++i){
-    error_check(cursor_->get_value(cursor_, &v));
+    error_check(cursor->get_value(cursor, &v));
     result.emplace_back(std::vector<Field>());
     if (fields != nullptr) {
       DeserializeRowFilter(&result.back(), (const char*)v.data, v.size, *fields);
     } else {
       DeserializeRow(&result.back(), (const char*)v.data, v.size);
     }
+    if (i + 1 < len) {
+      ret = cursor->next(cursor);
+    }
+  }
+  if (ret != 0 && ret != WT_NOTFOUND) {
+    return Failed(ret, "scan");
   }
+  error_check(cursor->reset(cursor));
   return kOK;
 }
 
 DB::Status WTDB::UpdateSingleEntry(const std::string &table, const std::string &key,
                            std::vector<Field> &values){
+  WT_CURSOR *cursor = Cursor(table);
   std::vector<Field> current_values;
   WT_ITEM k = {key.data(), key.size()};
   WT_ITEM v;
   int ret;
 
-  cursor_->set_key(cursor_, &k);
-  ret = cursor_->search(cursor_);
+  cursor->set_key(cursor, &k);
+  ret = cursor->search(cursor);
   if(ret==WT_NOTFOUND){
     return kNotFound;
   } else if(ret != 0) {
-    throw utils::Exception(WT_PREFIX " search error");
+    return Failed(ret, "search");
   }
-  error_check(cursor_->get_value(cursor_, &v));
+  error_check(cursor->get_value(cursor, &v));
   DeserializeRow(&current_values, (const char*)v.data, v.size);
   for (Field &new_field : values) {
     bool found MAYBE_UNUSED = false;
     for (Field &cur_field : current_values) {
-      if (cur_field.name == new_field.name) {
+      if (cur_field.first == new_field.first) {
         found = true;
-        cur_field.value = new_field.value;
+        cur_field.second = new_field.second;
         break;
       }
     }
@@ -282,45 +809,371 @@ DB::Status WTDB::UpdateSingleEntry(const std::string &table, const std::string &
   SerializeRow(current_values, &data);
   v.data = data.data();
   v.size = data.size();
-  cursor_->set_value(cursor_, &v);
-  ret = cursor_->update(cursor_);
+  cursor->set_value(cursor, &v);
+  ret = cursor->update(cursor);
   if(ret==WT_NOTFOUND){
     return kNotFound;
   } else if(ret != 0) {
-    throw utils::Exception(WT_PREFIX " update error");
+    return Failed(ret, "update");
   }
+  error_check(cursor->reset(cursor));
   return kOK;
 }
 
 DB::Status WTDB::InsertSingleEntry(const std::string &table, const std::string &key,
                            std::vector<Field> &values){
+  WT_CURSOR *cursor = Cursor(table);
   std::string data;
   WT_ITEM k = {key.data(), key.size()}, v;
   
-  cursor_->set_key(cursor_, &k);
+  cursor->set_key(cursor, &k);
   SerializeRow(values, &data);
   v.data = data.data();
   v.size = data.size();
-  cursor_->set_value(cursor_, &v);
-  error_check(cursor_->insert(cursor_));
-  // TODO: cursor reset?
+  cursor->set_value(cursor, &v);
+  int ret = cursor->insert(cursor);
+  if (ret != 0) {
+    return Failed(ret, "insert");
+  }
   return kOK;
 }
+
 DB::Status WTDB::DeleteSingleEntry(const std::string &table, const std::string &key){
+  WT_CURSOR *cursor = Cursor(table);
   WT_ITEM k = {key.data(), key.size()};
-  cursor_->set_key(cursor_, &k);
-  error_check(cursor_->remove(cursor_));
+  cursor->set_key(cursor, &k);
+  int ret = cursor->remove(cursor);
+  if (ret != 0) {
+    return Failed(ret, "remove");
+  }
+  return kOK;
+}
+
+std::string WTDB::BuildCompKey(const std::string &key, const std::string &field_name) {
+  return key + ":" + field_name;
+}
+
+std::string WTDB::KeyFromCompKey(const WT_ITEM &comp_key) {
+  const char *data = static_cast<const char *>(comp_key.data);
+  const char *sep = static_cast<const char *>(memchr(data, ':', comp_key.size));
+  assert(sep != nullptr);
+  return std::string(data, sep - data);
+}
+
+std::string WTDB::FieldFromCompKey(const WT_ITEM &comp_key) {
+  const char *data = static_cast<const char *>(comp_key.data);
+  const char *sep = static_cast<const char *>(memchr(data, ':', comp_key.size));
+  assert(sep != nullptr);
+  return std::string(sep + 1, data + comp_key.size - sep - 1);
+}
+
+DB::Status WTDB::ReadCompKey(const std::string &table, const std::string &key,
+                             const std::vector<std::string> *fields,
+                             std::vector<Field> &result) {
+  WT_CURSOR *cursor = Cursor(table);
+  WT_ITEM k, v;
+  int ret;
+  if (fields != nullptr) {
+    for (const std::string &field : *fields) {
+      const std::string comp_key = BuildCompKey(key, field);
+      k = {comp_key.data(), comp_key.size()};
+      cursor->set_key(cursor, &k);
+      ret = cursor->search(cursor);
+      if (ret == WT_NOTFOUND) {
+        error_check(cursor->reset(cursor));
+        return kNotFound;
+      } else if (ret != 0) {
+        return Failed(ret, "search");
+      }
+      error_check(cursor->get_value(cursor, &v));
+      result.push_back({field, std::string(static_cast<const char *>(v.data), v.size)});
+    }
+    error_check(cursor->reset(cursor));
+    return kOK;
+  }
+  // all fields of a row share the "<key>:" prefix
+  const std::string prefix = key + ":";
+  int exact;
+  k = {prefix.data(), prefix.size()};
+  cursor->set_key(cursor, &k);
+  ret = cursor->search_near(cursor, &exact);
+  if (ret == 0 && exact < 0) {
+    ret = cursor->next(cursor);
+  }
+  while (ret == 0) {
+    error_check(cursor->get_key(cursor, &k));
+    if (k.size < prefix.size() || memcmp(k.data, prefix.data(), prefix.size()) != 0) {
+      break;
+    }
+    error_check(cursor->get_value(cursor, &v));
+    result.push_back({FieldFromCompKey(k), std::string(static_cast<const char *>(v.data), v.size)});
+    ret = cursor->next(cursor);
+  }
+  if (ret != 0 && ret != WT_NOTFOUND) {
+    return Failed(ret, "next");
+  }
+  error_check(cursor->reset(cursor));
+  if (result.empty()) {
+    return kNotFound;
+  }
+  assert(result.size() == fieldcount_);
+  return kOK;
+}
+
+DB::Status WTDB::ScanCompKey(const std::string &table, const std::string &key, int len,
+                             const std::vector<std::string> *fields,
+                             std::vector<std::vector<Field>> &result) {
+  WT_CURSOR *cursor = Cursor(table);
+  WT_ITEM k = {key.data(), key.size()};
+  WT_ITEM v;
+  int ret, exact;
+
+  cursor->set_key(cursor, &k);
+  ret = cursor->search_near(cursor, &exact);
+  if (ret == 0 && exact < 0) {
+    ret = cursor->next(cursor);
+  }
+  std::string cur_key;
+  while (ret == 0) {
+    error_check(cursor->get_key(cursor, &k));
+    std::string row_key = KeyFromCompKey(k);
+    if (result.empty() || row_key != cur_key) {
+      if (result.size() == static_cast<size_t>(len)) {
+        break;
+      }
+      result.push_back(std::vector<Field>());
+      cur_key = std::move(row_key);
+    }
+    std::string field = FieldFromCompKey(k);
+    if (fields == nullptr || std::find(fields->begin(), fields->end(), field) != fields->end()) {
+      error_check(cursor->get_value(cursor, &v));
+      result.back().push_back({std::move(field), std::string(static_cast<const char *>(v.data), v.size)});
+    }
+    ret = cursor->next(cursor);
+  }
+  if (ret != 0 && ret != WT_NOTFOUND) {
+    return Failed(ret, "next");
+  }
+  error_check(cursor->reset(cursor));
+  return kOK;
+}
+
+DB::Status WTDB::InsertCompKey(const std::string &table, const std::string &key,
+                               std::vector<Field> &values) {
+  WT_CURSOR *cursor = Cursor(table);
+  // the fields of a row are written atomically, in the batch or in a transaction of their own
+  const bool own_txn = !in_txn_;
+  if (own_txn) {
+    error_check(session_->begin_transaction(session_, NULL));
+  }
+  std::string comp_key;
+  for (Field &field : values) {
+    comp_key = BuildCompKey(key, field.first);
+    WT_ITEM k = {comp_key.data(), comp_key.size()};
+    WT_ITEM v = {field.second.data(), field.second.size()};
+    cursor->set_key(cursor, &k);
+    cursor->set_value(cursor, &v);
+    int ret = cursor->insert(cursor);
+    if (ret != 0) {
+      if (own_txn) {
+        error_check(session_->rollback_transaction(session_, NULL));
+      }
+      return Failed(ret, "insert");
+    }
+  }
+  if (own_txn) {
+    int ret = session_->commit_transaction(session_, commit_config_.c_str());
+    if (ret != 0) {
+      return Failed(ret, "commit_transaction");
+    }
+  }
+  return kOK;
+}
+
+DB::Status WTDB::DeleteCompKey(const std::string &table, const std::string &key) {
+  WT_CURSOR *cursor = Cursor(table);
+  const bool own_txn = !in_txn_;
+  if (own_txn) {
+    error_check(session_->begin_transaction(session_, NULL));
+  }
+  std::string comp_key;
+  for (unsigned i = 0; i < fieldcount_; i++) {
+    comp_key = BuildCompKey(key, field_prefix_ + std::to_string(i));
+    WT_ITEM k = {comp_key.data(), comp_key.size()};
+    cursor->set_key(cursor, &k);
+    int ret = cursor->remove(cursor);
+    if (ret != 0) {
+      if (own_txn) {
+        error_check(session_->rollback_transaction(session_, NULL));
+      }
+      return Failed(ret, "remove");
+    }
+  }
+  if (own_txn) {
+    int ret = session_->commit_transaction(session_, commit_config_.c_str());
+    if (ret != 0) {
+      return Failed(ret, "commit_transaction");
+    }
+  }
+  return kOK;
+}
+
+size_t WTDB::ColumnIndex(const std::string &field) {
+  auto it = std::find(columns_.begin(), columns_.end(), field);
+  if (it == columns_.end()) {
+    throw utils::Exception(WT_PREFIX " unknown column " + field);
+  }
+  return it - columns_.begin();
+}
+
+void WTDB::PackColumns(std::vector<WT_ITEM> &items, std::string *data) {
+  // each item but the last is prefixed by its packed length, at most 9 bytes
+  size_t size = 0;
+  for (const WT_ITEM &item : items) {
+    size += item.size + 9;
+  }
+  data->resize(size);
+  WT_PACK_STREAM *stream;
+  size_t used;
+  error_check(wiredtiger_pack_start(session_, value_format_.c_str(), &(*data)[0], size, &stream));
+  for (WT_ITEM &item : items) {
+    error_check(wiredtiger_pack_item(stream, &item));
+  }
+  error_check(wiredtiger_pack_close(stream, &used));
+  data->resize(used);
+}
+
+void WTDB::UnpackColumns(const WT_ITEM &data, size_t n, std::vector<WT_ITEM> *items) {
+  const std::string format(n, 'u');
+  WT_PACK_STREAM *stream;
+  size_t used;
+  error_check(wiredtiger_unpack_start(session_, format.c_str(), data.data, data.size, &stream));
+  items->resize(n);
+  for (WT_ITEM &item : *items) {
+    error_check(wiredtiger_unpack_item(stream, &item));
+  }
+  error_check(wiredtiger_pack_close(stream, &used));
+}
+
+DB::Status WTDB::ReadColumnGroup(const std::string &table, const std::string &key,
+                                 const std::vector<std::string> *fields,
+                                 std::vector<Field> &result) {
+  // a projection reads only the column groups of the requested fields
+  WT_CURSOR *cursor = fields != nullptr ? ProjectionCursor(table, *fields) : Cursor(table);
+  const std::vector<std::string> &names = fields != nullptr ? *fields : columns_;
+  WT_ITEM k = {key.data(), key.size()};
+  WT_ITEM v;
+  cursor->set_key(cursor, &k);
+  int ret = cursor->search(cursor);
+  if (ret == WT_NOTFOUND) {
+    return kNotFound;
+  } else if (ret != 0) {
+    return Failed(ret, "search");
+  }
+  error_check(cursor->get_value(cursor, &v));
+  std::vector<WT_ITEM> items;
+  UnpackColumns(v, names.size(), &items);
+  for (size_t i = 0; i < names.size(); i++) {
+    result.push_back({names[i], std::string(static_cast<const char *>(items[i].data), items[i].size)});
+  }
+  error_check(cursor->reset(cursor));
+  return kOK;
+}
+
+DB::Status WTDB::ScanColumnGroup(const std::string &table, const std::string &key, int len,
+                                 const std::vector<std::string> *fields,
+                                 std::vector<std::vector<Field>> &result) {
+  WT_CURSOR *cursor = fields != nullptr ? ProjectionCursor(table, *fields) : Cursor(table);
+  const std::vector<std::string> &names = fields != nullptr ? *fields : columns_;
+  WT_ITEM k = {key.data(), key.size()};
+  WT_ITEM v;
+  std::vector<WT_ITEM> items;
+  int ret, exact;
+
+  cursor->set_key(cursor, &k);
+  ret = cursor->search_near(cursor, &exact);
+  if (ret == 0 && exact < 0) {
+    ret = cursor->next(cursor);
+  }
+  for (int i = 0; !ret && i < len; ++i) {
+    error_check(cursor->get_value(cursor, &v));
+    UnpackColumns(v, names.size(), &items);
+    result.emplace_back(std::vector<Field>());
+    for (size_t f = 0; f < names.size(); f++) {
+      result.back().push_back({names[f], std::string(static_cast<const char *>(items[f].data), items[f].size)});
+    }
+    if (i + 1 < len) {
+      ret = cursor->next(cursor);
+    }
+  }
+  if (ret != 0 && ret != WT_NOTFOUND) {
+    return Failed(ret, "scan");
+  }
+  error_check(cursor->reset(cursor));
+  return kOK;
+}
+
+DB::Status WTDB::UpdateColumnGroup(const std::string &table, const std::string &key,
+                                   std::vector<Field> &values) {
+  WT_CURSOR *cursor = Cursor(table);
+  WT_ITEM k = {key.data(), key.size()};
+  WT_ITEM v;
+  cursor->set_key(cursor, &k);
+  int ret = cursor->search(cursor);
+  if (ret == WT_NOTFOUND) {
+    return kNotFound;
+  } else if (ret != 0) {
+    return Failed(ret, "search");
+  }
+  error_check(cursor->get_value(cursor, &v));
+  // the unchanged items point into the cursor's page, packed before it moves
+  std::vector<WT_ITEM> items;
+  UnpackColumns(v, columns_.size(), &items);
+  for (Field &field : values) {
+    items[ColumnIndex(field.first)] = {field.second.data(), field.second.size()};
+  }
+  std::string data;
+  PackColumns(items, &data);
+  v = {data.data(), data.size()};
+  cursor->set_value(cursor, &v);
+  ret = cursor->update(cursor);
+  if (ret == WT_NOTFOUND) {
+    return kNotFound;
+  } else if (ret != 0) {
+    return Failed(ret, "update");
+  }
+  error_check(cursor->reset(cursor));
+  return kOK;
+}
+
+DB::Status WTDB::InsertColumnGroup(const std::string &table, const std::string &key,
+                                   std::vector<Field> &values) {
+  WT_CURSOR *cursor = Cursor(table);
+  std::vector<WT_ITEM> items(columns_.size(), WT_ITEM{});
+  for (Field &field : values) {
+    items[ColumnIndex(field.first)] = {field.second.data(), field.second.size()};
+  }
+  std::string data;
+  PackColumns(items, &data);
+  WT_ITEM k = {key.data(), key.size()};
+  WT_ITEM v = {data.data(), data.size()};
+  cursor->set_key(cursor, &k);
+  cursor->set_value(cursor, &v);
+  int ret = cursor->insert(cursor);
+  if (ret != 0) {
+    return Failed(ret, "insert");
+  }
   return kOK;
 }
 
 void WTDB::SerializeRow(const std::vector<Field> &values, std::string *data) {
   for (const Field &field : values) {
-    uint32_t len = field.name.size();
+    uint32_t len = field.first.size();
     data->append(reinterpret_cast<char *>(&len), sizeof(uint32_t)); // 4B
-    data->append(field.name.data(), field.name.size());             // len(name)
-    len = field.value.size();
+    data->append(field.first.data(), field.first.size());             // len(name)
+    len = field.second.size();
     data->append(reinterpret_cast<char *>(&len), sizeof(uint32_t)); // 4B
-    data->append(field.value.data(), field.value.size());           // len(value)
+    data->append(field.second.data(), field.second.size());           // len(value)
   }
 }
 
@@ -6,6 +6,8 @@
 
 #include <string>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "core/db.h"
 #include "utils/properties.h"
@@ -24,29 +26,47 @@ class WTDB : public DB {
 
   void Cleanup();
 
+  bool ReInitBeforeTransaction() override;
+
   Status Read(const std::string &table, const std::string &key,
               const std::vector<std::string> *fields, std::vector<Field> &result) {
-    return (this->*(method_read_))(table, key, fields, result);
+    BatchBegin();
+    return BatchEnd((this->*(method_read_))(table, key, fields, result));
   }
 
   Status Scan(const std::string &table, const std::string &key, int len,
               const std::vector<std::string> *fields, std::vector<std::vector<Field>> &result) {
-    return (this->*(method_scan_))(table, key, len, fields, result);
+    BatchBegin();
+    return BatchEnd((this->*(method_scan_))(table, key, len, fields, result));
   }
 
   Status Update(const std::string &table, const std::string &key, std::vector<Field> &values) {
-    return (this->*(method_update_))(table, key, values);
+    BatchBegin();
+    return BatchEnd((this->*(method_update_))(table, key, values));
   }
 
   Status Insert(const std::string &table, const std::string &key, std::vector<Field> &values) {
-    return (this->*(method_insert_))(table, key, values);
+    BatchBegin();
+    return BatchEnd((this->*(method_insert_))(table, key, values));
   }
 
   Status Delete(const std::string &table, const std::string &key) {
-    return (this->*(method_delete_))(table, key);
+    BatchBegin();
+    return BatchEnd((this->*(method_delete_))(table, key));
   }
 
+  Status BeginTransaction() override;
+  Status CommitTransaction() override;
+  Status AbortTransaction() override;
+
+  std::string GetStatusMsg() override;
+  void EmitStats(YAML::Node &node) override;
+
  private:
+  WT_CURSOR *Cursor(const std::string &table) {
+    auto it = cursors_.find(table);
+    return it == cursors_.end() ? cursor_ : it->second;
+  }
 
   Status ReadSingleEntry(const std::string &table, const std::string &key,
                          const std::vector<std::string> *fields, std::vector<Field> &result);
@@ -59,6 +79,59 @@ class WTDB : public DB {
                            std::vector<Field> &values);
   Status DeleteSingleEntry(const std::string &table, const std::string &key);
 
+  Status ReadCompKey(const std::string &table, const std::string &key,
+                     const std::vector<std::string> *fields, std::vector<Field> &result);
+  Status ScanCompKey(const std::string &table, const std::string &key, int len,
+                     const std::vector<std::string> *fields,
+                     std::vector<std::vector<Field>> &result);
+  Status InsertCompKey(const std::string &table, const std::string &key,
+                       std::vector<Field> &values);
+  Status DeleteCompKey(const std::string &table, const std::string &key);
+
+  Status ReadColumnGroup(const std::string &table, const std::string &key,
+                         const std::vector<std::string> *fields, std::vector<Field> &result);
+  Status ScanColumnGroup(const std::string &table, const std::string &key, int len,
+                         const std::vector<std::string> *fields,
+                         std::vector<std::vector<Field>> &result);
+  Status UpdateColumnGroup(const std::string &table, const std::string &key,
+                           std::vector<Field> &values);
+  Status InsertColumnGroup(const std::string &table, const std::string &key,
+                           std::vector<Field> &values);
+
+  ///
+  /// Starts a batch transaction before an operation when wiredtiger.txn_batch
+  /// is set and none is open.
+  ///
+  void BatchBegin();
+  ///
+  /// Commits the batch transaction after its txn_batch-th operation, or
+  /// rolls it back when the operation failed on a conflict.
+  ///
+  Status BatchEnd(Status s);
+  bool Commit();
+  ///
+  /// kError for WT_ROLLBACK (a write conflict or cache pressure), the
+  /// operation's transaction must then be rolled back. Throws otherwise.
+  ///
+  static Status Failed(int ret, const char *op);
+
+  void CreateTable(const std::string &name, const std::string &storage_config);
+  void OpenCursors(const utils::Properties &props);
+  WT_CURSOR *ProjectionCursor(const std::string &table, const std::vector<std::string> &fields);
+  static void CreateCheckpoint();
+  ///
+  /// Reads the counters of kStats into the last sample, needs mu_.
+  ///
+  static void SampleStats();
+
+  std::string BuildCompKey(const std::string &key, const std::string &field_name);
+  static std::string KeyFromCompKey(const WT_ITEM &comp_key);
+  static std::string FieldFromCompKey(const WT_ITEM &comp_key);
+
+  size_t ColumnIndex(const std::string &field);
+  void PackColumns(std::vector<WT_ITEM> &items, std::string *data);
+  void UnpackColumns(const WT_ITEM &data, size_t n, std::vector<WT_ITEM> *items);
+
   void SerializeRow(const std::vector<Field> &values, std::string *data);
   void DeserializeRow(std::vector<Field> *values, const char *data_ptr, size_t data_len);
   void DeserializeRowFilter(std::vector<Field> *values, const char *data_ptr, size_t data_len, const std::vector<std::string> &fields);
@@ -74,18 +147,35 @@ class WTDB : public DB {
                                       std::vector<Field> &);
   Status (WTDB::*method_delete_)(const std::string &, const std::string &);
   
+  enum Format { kSingleRow, kRowMajor, kColumnGroup };
+  Format format_;
+
   unsigned fieldcount_;
+  std::string field_prefix_;
+  // column format: field0..fieldN-1, one column group each
+  std::vector<std::string> columns_;
+  std::string value_format_;
 
   static WT_CONNECTION *conn_;
+  static WT_SESSION *stats_session_;
   WT_SESSION *session_{nullptr};
   WT_CURSOR *cursor_{nullptr};
+  std::unordered_map<std::string, WT_CURSOR *> cursors_;
+  // column format: cursors on a projection of the columns, by uri
+  std::unordered_map<std::string, WT_CURSOR *> projections_;
+
+  int txn_batch_{0};
+  int batch_ops_{0};
+  bool in_txn_{false};
+  bool explicit_txn_{false};
+  std::string commit_config_;
 
   static int ref_cnt_;
   static std::mutex mu_;
 
 };
 
-DB *NewRocksdbDB();
+DB *NewWTDB();
 
 } // namespace ycsbc
 